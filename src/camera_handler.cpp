@@ -1,6 +1,12 @@
 #include "camera_handler.h"
+#include <chrono>
 #include <iostream>
 
+#ifdef RLFT_HAVE_V4L2
+#include <linux/videodev2.h>
+#include "v4l2_capture.h"
+#endif
+
 namespace
 {
   bool TryOpen(cv::VideoCapture& cap, int device_index, int api)
@@ -12,14 +18,21 @@ namespace
 
     return cap.open(device_index);
   }
+
+  uint64_t SteadyNowNs()
+  {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
 } // namespace
 
 namespace camh
 {
   CameraHandler::CameraHandler(int device_index, int requested_width, int requested_height, int requested_fps)
     : cap_()
+    , v4l2_()
     , width_(0)
     , height_(0)
+    , fps_(0.0)
   {
     bool opened = false;
 
@@ -46,8 +59,43 @@ namespace camh
 
     width_ = (int)cap_.get(cv::CAP_PROP_FRAME_WIDTH);
     height_ = (int)cap_.get(cv::CAP_PROP_FRAME_HEIGHT);
+    fps_ = cap_.get(cv::CAP_PROP_FPS);
 
-    std::cerr << "Camera opened. Backend=" << cap_.get(cv::CAP_PROP_BACKEND) << " WxH=" << width_ << "x" << height_ << " FPS=" << cap_.get(cv::CAP_PROP_FPS) << "\n";
+    std::cerr << "Camera opened. Backend=" << cap_.get(cv::CAP_PROP_BACKEND) << " WxH=" << width_ << "x" << height_ << " FPS=" << fps_ << "\n";
+  }
+
+  CameraHandler::CameraHandler(const std::string& v4l2_device, int requested_width, int requested_height, int requested_fps)
+    : cap_()
+    , v4l2_()
+    , width_(0)
+    , height_(0)
+    , fps_(0.0)
+  {
+#ifdef RLFT_HAVE_V4L2
+    const std::string file_prefix = "file:";
+    std::unique_ptr<V4L2Device> device;
+    if (v4l2_device.compare(0, file_prefix.size(), file_prefix) == 0)
+      device = std::make_unique<FileV4L2Device>(v4l2_device.substr(file_prefix.size()), requested_width, requested_height, V4L2_PIX_FMT_YUYV, requested_fps);
+    else
+      device = std::make_unique<SystemV4L2Device>(v4l2_device);
+
+    v4l2_ = std::make_shared<V4L2Capture>(std::move(device), requested_width, requested_height, requested_fps, V4L2_PIX_FMT_YUYV, 4);
+    if (!v4l2_->IsOpened())
+    {
+      std::cerr << "Could not open V4L2 device " << v4l2_device << "\n";
+      v4l2_.reset();
+      return;
+    }
+
+    width_ = v4l2_->Width();
+    height_ = v4l2_->Height();
+    fps_ = v4l2_->Fps();
+#else
+    (void)requested_width;
+    (void)requested_height;
+    (void)requested_fps;
+    std::cerr << "V4L2 capture is not available in this build, cannot open " << v4l2_device << "\n";
+#endif
   }
 
   CameraHandler::~CameraHandler()
@@ -58,7 +106,7 @@ namespace camh
 
   bool CameraHandler::IsOpened() const
   {
-    return cap_.isOpened();
+    return cap_.isOpened() || v4l2_ != nullptr;
   }
 
   int CameraHandler::Width() const
@@ -71,6 +119,11 @@ namespace camh
     return height_;
   }
 
+  double CameraHandler::Fps() const
+  {
+    return fps_;
+  }
+
   bool CameraHandler::Read(cv::Mat& out_bgr)
   {
     if (!cap_.isOpened())
@@ -87,4 +140,64 @@ namespace camh
     out_bgr = frame;
     return true;
   }
+
+  bool CameraHandler::ReadFrame(cv::Mat& out_rgba, cv::Mat& out_gray, uint64_t& capture_ns)
+  {
+    if (v4l2_)
+    {
+      cv::Mat raw;
+      if (!GrabV4L2(raw, capture_ns))
+        return false;
+
+      // YUYV interleaves luma with chroma, one strided pass pulls out Y instead of a BGR decode plus gray conversion.
+      cv::cvtColor(raw, out_rgba, cv::COLOR_YUV2RGBA_YUYV);
+      cv::extractChannel(raw, gray_, 0);
+      out_gray = gray_;
+      return true;
+    }
+
+    if (!cap_.isOpened())
+      return false;
+
+    if (!cap_.read(frame_) || frame_.empty())
+      return false;
+
+    capture_ns = SteadyNowNs();
+
+    cv::cvtColor(frame_, out_rgba, cv::COLOR_BGR2RGBA);
+    cv::cvtColor(frame_, gray_, cv::COLOR_BGR2GRAY);
+    out_gray = gray_;
+    return true;
+  }
+
+  bool CameraHandler::GrabV4L2(cv::Mat& out_raw, uint64_t& capture_ns)
+  {
+#ifdef RLFT_HAVE_V4L2
+    V4L2Frame f;
+    if (!v4l2_->Grab(f))
+      return false;
+
+    if ((int)f.bytes_used < v4l2_->BytesPerLine() * height_)
+      return false;
+
+    capture_ns = (f.timestamp_ns != 0) ? f.timestamp_ns : SteadyNowNs();
+
+    // Zero-copy view of the mmap'd driver buffer, valid until the next grab queues it back.
+    out_raw = cv::Mat(height_, width_, CV_8UC2, const_cast<uint8_t*>(f.data), (size_t)v4l2_->BytesPerLine());
+    return true;
+#else
+    (void)out_raw;
+    (void)capture_ns;
+    return false;
+#endif
+  }
+
+  const V4L2Stats* CameraHandler::CaptureStats() const
+  {
+#ifdef RLFT_HAVE_V4L2
+    if (v4l2_)
+      return &v4l2_->Stats();
+#endif
+    return nullptr;
+  }
 } // namespace camh
\ No newline at end of file
@@ -1,26 +1,51 @@
 #ifndef CAMERA_HANDLER_H
 #define CAMERA_HANDLER_H
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <opencv2/opencv.hpp>
 
 namespace camh
 {
+  class V4L2Capture;
+  struct V4L2Stats;
+
   class CameraHandler
   {
   public:
     CameraHandler(int device_index, int requested_width, int requested_height, int requested_fps);
+    // Native V4L2 mmap capture in YUYV. "file:<path>" replays raw YUYV frames through the fake device instead.
+    CameraHandler(const std::string& v4l2_device, int requested_width, int requested_height, int requested_fps);
     ~CameraHandler();
 
     bool IsOpened() const;
     int Width() const;
     int Height() const;
+    double Fps() const;
 
+    // cv::VideoCapture only, V4L2 frames are read with ReadFrame.
     bool Read(cv::Mat& out_bgr);
 
+    // Display and CV inputs of one frame. With V4L2 both come straight from the YUYV driver buffer,
+    // out_gray is its luma channel, no BGR decode happens in between. capture_ns is on the steady_clock:
+    // the driver timestamp with V4L2, the time the frame was returned with cv::VideoCapture.
+    bool ReadFrame(cv::Mat& out_rgba, cv::Mat& out_gray, uint64_t& capture_ns);
+
+    // Buffer, drop and capture latency statistics of the V4L2 backend, nullptr with cv::VideoCapture.
+    const V4L2Stats* CaptureStats() const;
+
   private:
+    bool GrabV4L2(cv::Mat& out_raw, uint64_t& capture_ns);
+
     cv::VideoCapture cap_;
+    // shared_ptr so builds without V4L2 never need the complete type.
+    std::shared_ptr<V4L2Capture> v4l2_;
+    cv::Mat frame_;
+    cv::Mat gray_;
     int width_;
     int height_;
+    double fps_;
   };
 } // namespace camh
 
@@ -0,0 +1,217 @@
+#include "debug_overlay.h"
+#include <cmath>
+#include <rlgl.h>
+
+namespace
+{
+  Rectangle WhiteTexelUV(Texture2D& out_tex)
+  {
+    // Glyphs come from the default font, so the white texel has to live in that texture to keep a single batch.
+    Font font = GetFontDefault();
+    out_tex = font.texture;
+    Rectangle src = (Rectangle){font.recs[95].x + 2.0f, font.recs[95].y + 2.0f, 1.0f, 1.0f};
+#if defined(RAYLIB_VERSION_MAJOR) && (RAYLIB_VERSION_MAJOR >= 5)
+    if (GetShapesTexture().id == font.texture.id)
+      src = GetShapesTextureRectangle();
+#endif
+    // Sample the center of the white area so filtering never picks up neighbouring glyph texels.
+    float cx = (src.x + src.width * 0.5f) / (float)out_tex.width;
+    float cy = (src.y + src.height * 0.5f) / (float)out_tex.height;
+    return (Rectangle){cx, cy, 0.0f, 0.0f};
+  }
+} // namespace
+
+namespace rlft
+{
+  DebugOverlay::DebugOverlay()
+    : tex_()
+    , white_uv_()
+    , scale_(1.0f)
+    , off_x_(0.0f)
+    , off_y_(0.0f)
+  {
+  }
+
+  void DebugOverlay::Begin(float scale, float off_x, float off_y)
+  {
+    image_verts_.clear();
+    screen_verts_.clear();
+    scale_ = (scale > 0.0f) ? scale : 1.0f;
+    off_x_ = off_x;
+    off_y_ = off_y;
+    white_uv_ = WhiteTexelUV(tex_);
+  }
+
+  std::vector<DebugOverlay::Vertex>& DebugOverlay::Buffer(Layer layer)
+  {
+    return (layer == Layer::Image) ? image_verts_ : screen_verts_;
+  }
+
+  float DebugOverlay::PixelSize(Layer layer) const
+  {
+    return (layer == Layer::Image) ? (1.0f / scale_) : 1.0f;
+  }
+
+  void DebugOverlay::PushQuad(Layer layer, const Vector2 (&p)[4], const Rectangle& uv, Color color)
+  {
+    std::vector<Vertex>& buf = Buffer(layer);
+
+    // rlgl quads are counter-clockwise: top-left, bottom-left, bottom-right, top-right.
+    buf.push_back({p[0].x, p[0].y, uv.x, uv.y, color});
+    buf.push_back({p[1].x, p[1].y, uv.x, uv.y + uv.height, color});
+    buf.push_back({p[2].x, p[2].y, uv.x + uv.width, uv.y + uv.height, color});
+    buf.push_back({p[3].x, p[3].y, uv.x + uv.width, uv.y, color});
+  }
+
+  void DebugOverlay::AddFace(const cvfd::FacePose& fp)
+  {
+    AddRectLines(Layer::Image, cv::Rect2f((float)fp.bbox.x, (float)fp.bbox.y, (float)fp.bbox.width, (float)fp.bbox.height), 1.0f, RED);
+
+    for (size_t i = 0; i < fp.landmarks_68.size(); i++)
+      AddPoint(Layer::Image, fp.landmarks_68[i], 2.0f, YELLOW);
+
+    if (fp.axis_points.size() >= 4)
+    {
+      AddLine(Layer::Image, fp.axis_points[0], fp.axis_points[1], 2.0f, RED);
+      AddLine(Layer::Image, fp.axis_points[0], fp.axis_points[2], 2.0f, GREEN);
+      AddLine(Layer::Image, fp.axis_points[0], fp.axis_points[3], 2.0f, BLUE);
+    }
+  }
+
+  void DebugOverlay::AddPoint(Layer layer, const cv::Point2f& p, float radius_px, Color color)
+  {
+    float r = radius_px * PixelSize(layer);
+
+    Vector2 q[4] = {{p.x - r, p.y - r}, {p.x - r, p.y + r}, {p.x + r, p.y + r}, {p.x + r, p.y - r}};
+    PushQuad(layer, q, white_uv_, color);
+  }
+
+  void DebugOverlay::AddLine(Layer layer, const cv::Point2f& a, const cv::Point2f& b, float thick_px, Color color)
+  {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float len = std::sqrt(dx * dx + dy * dy);
+    if (len < 1e-6f)
+      return;
+
+    float h = thick_px * 0.5f * PixelSize(layer);
+    float nx = -dy / len * h;
+    float ny = dx / len * h;
+
+    Vector2 q[4] = {{a.x + nx, a.y + ny}, {a.x - nx, a.y - ny}, {b.x - nx, b.y - ny}, {b.x + nx, b.y + ny}};
+    PushQuad(layer, q, white_uv_, color);
+  }
+
+  void DebugOverlay::AddRectLines(Layer layer, const cv::Rect2f& r, float thick_px, Color color)
+  {
+    float t = thick_px * PixelSize(layer);
+
+    float x0 = r.x;
+    float y0 = r.y;
+    float x1 = r.x + r.width;
+    float y1 = r.y + r.height;
+
+    Vector2 top[4] = {{x0, y0}, {x0, y0 + t}, {x1, y0 + t}, {x1, y0}};
+    Vector2 bottom[4] = {{x0, y1 - t}, {x0, y1}, {x1, y1}, {x1, y1 - t}};
+    Vector2 left[4] = {{x0, y0 + t}, {x0, y1 - t}, {x0 + t, y1 - t}, {x0 + t, y0 + t}};
+    Vector2 right[4] = {{x1 - t, y0 + t}, {x1 - t, y1 - t}, {x1, y1 - t}, {x1, y0 + t}};
+
+    PushQuad(layer, top, white_uv_, color);
+    PushQuad(layer, bottom, white_uv_, color);
+    PushQuad(layer, left, white_uv_, color);
+    PushQuad(layer, right, white_uv_, color);
+  }
+
+  void DebugOverlay::AddText(Layer layer, const cv::Point2f& pos, const char* text, float font_px, Color color)
+  {
+    if (text == nullptr)
+      return;
+
+    Font font = GetFontDefault();
+    float s = font_px * PixelSize(layer) / (float)font.baseSize;
+    float spacing = font_px * PixelSize(layer) / 10.0f;
+    float pad = (float)font.glyphPadding;
+    float pen_x = pos.x;
+    float pen_y = pos.y;
+
+    int i = 0;
+    while (text[i] != '\0')
+    {
+      int cp_size = 0;
+      int cp = GetCodepointNext(&text[i], &cp_size);
+      i += cp_size;
+
+      if (cp == '\n')
+      {
+        pen_x = pos.x;
+        pen_y += font_px * PixelSize(layer) * 1.5f;
+        continue;
+      }
+
+      int gi = GetGlyphIndex(font, cp);
+      const Rectangle& rec = font.recs[gi];
+      const GlyphInfo& glyph = font.glyphs[gi];
+
+      if (cp != ' ' && cp != '\t')
+      {
+        float x = pen_x + (glyph.offsetX - pad) * s;
+        float y = pen_y + (glyph.offsetY - pad) * s;
+        float w = (rec.width + 2.0f * pad) * s;
+        float h = (rec.height + 2.0f * pad) * s;
+
+        Rectangle uv;
+        uv.x = (rec.x - pad) / (float)font.texture.width;
+        uv.y = (rec.y - pad) / (float)font.texture.height;
+        uv.width = (rec.width + 2.0f * pad) / (float)font.texture.width;
+        uv.height = (rec.height + 2.0f * pad) / (float)font.texture.height;
+
+        Vector2 q[4] = {{x, y}, {x, y + h}, {x + w, y + h}, {x + w, y}};
+        PushQuad(layer, q, uv, color);
+      }
+
+      pen_x += ((glyph.advanceX == 0) ? rec.width * s : (float)glyph.advanceX * s) + spacing;
+    }
+  }
+
+  void DebugOverlay::Draw()
+  {
+    int total = VertexCount();
+    if (total == 0)
+      return;
+
+    rlCheckRenderBatchLimit(total);
+    rlSetTexture(tex_.id);
+
+    rlPushMatrix();
+    rlTranslatef(off_x_, off_y_, 0.0f);
+    rlScalef(scale_, scale_, 1.0f);
+
+    rlBegin(RL_QUADS);
+    for (const Vertex& v : image_verts_)
+    {
+      rlColor4ub(v.color.r, v.color.g, v.color.b, v.color.a);
+      rlTexCoord2f(v.u, v.v);
+      rlVertex2f(v.x, v.y);
+    }
+    rlEnd();
+
+    rlPopMatrix();
+
+    // Same mode and texture as above, rlgl keeps appending to the current draw call.
+    rlBegin(RL_QUADS);
+    for (const Vertex& v : screen_verts_)
+    {
+      rlColor4ub(v.color.r, v.color.g, v.color.b, v.color.a);
+      rlTexCoord2f(v.u, v.v);
+      rlVertex2f(v.x, v.y);
+    }
+    rlEnd();
+
+    rlSetTexture(0);
+  }
+
+  int DebugOverlay::VertexCount() const
+  {
+    return (int)(image_verts_.size() + screen_verts_.size());
+  }
+} // namespace rlft
@@ -0,0 +1,64 @@
+#ifndef DEBUG_OVERLAY_H
+#define DEBUG_OVERLAY_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include <raylib.h>
+#include "face_cv.h"
+
+namespace rlft
+{
+  // Collects all 2D debug primitives of a frame into one quad buffer and submits it as a single batch.
+  // Image layer vertices are in camera image coordinates and mapped to the window by one matrix at Draw time,
+  // screen layer vertices are in window coordinates. Shapes and text share the default font texture, so both
+  // layers end up in the same draw call.
+  class DebugOverlay
+  {
+  public:
+    enum class Layer
+    {
+      Image,
+      Screen
+    };
+
+    DebugOverlay();
+
+    void Begin(float scale, float off_x, float off_y);
+
+    void AddFace(const cvfd::FacePose& fp);
+    void AddPoint(Layer layer, const cv::Point2f& p, float radius_px, Color color);
+    void AddLine(Layer layer, const cv::Point2f& a, const cv::Point2f& b, float thick_px, Color color);
+    void AddRectLines(Layer layer, const cv::Rect2f& r, float thick_px, Color color);
+    void AddText(Layer layer, const cv::Point2f& pos, const char* text, float font_px, Color color);
+
+    void Draw();
+
+    int VertexCount() const;
+
+  private:
+    struct Vertex
+    {
+      float x;
+      float y;
+      float u;
+      float v;
+      Color color;
+    };
+
+    std::vector<Vertex>& Buffer(Layer layer);
+    float PixelSize(Layer layer) const;
+    void PushQuad(Layer layer, const Vector2 (&p)[4], const Rectangle& uv, Color color);
+
+    std::vector<Vertex> image_verts_;
+    std::vector<Vertex> screen_verts_;
+
+    Texture2D tex_;
+    Rectangle white_uv_;
+
+    float scale_;
+    float off_x_;
+    float off_y_;
+  };
+} // namespace rlft
+
+#endif // DEBUG_OVERLAY_H
@@ -3,6 +3,54 @@
 
 namespace cvfd
 {
+  // Landmarks are fitted on fixed-size patches so their cost does not depend on face size or camera resolution.
+  // The patch covers the face box grown by half on every side, the same region FacemarkLBF crops internally.
+  static const int kPatchFaceSize = 128;
+  static const int kPatchSize = 2 * kPatchFaceSize;
+
+  // Bilinear sampling reads four pixels per sample whatever the face size, unlike INTER_AREA which reads the whole
+  // region. Faces shrunk by more than 2x are sampled at twice the patch size and pyrDown-filtered against aliasing.
+  static cv::Rect ExtractFacePatch(const cv::Mat& gray, const cv::Rect& face, cv::Mat& patch, cv::Mat& supersampled, cv::Point2f& origin, float& scale)
+  {
+    int side = std::max(face.width, face.height);
+    cv::Rect region(face.x + face.width / 2 - side, face.y + face.height / 2 - side, 2 * side, 2 * side);
+    origin = cv::Point2f((float)region.x, (float)region.y);
+    scale = (float)kPatchSize / (float)region.width;
+
+    bool supersample = scale < 0.5f;
+    int sample_size = supersample ? 2 * kPatchSize : kPatchSize;
+    float sample_scale = (float)sample_size / (float)region.width;
+    cv::Mat& sampled = supersample ? supersampled : patch;
+
+    if ((region & cv::Rect(0, 0, gray.cols, gray.rows)) == region)
+    {
+      cv::resize(gray(region), sampled, cv::Size(sample_size, sample_size), 0, 0, cv::INTER_LINEAR);
+    }
+    else
+    {
+      // Same pixel-center convention as cv::resize, edges replicated where the region leaves the image.
+      cv::Matx23f m(sample_scale, 0.0f, sample_scale * (0.5f - origin.x) - 0.5f, 0.0f, sample_scale, sample_scale * (0.5f - origin.y) - 0.5f);
+      cv::warpAffine(gray, sampled, m, cv::Size(sample_size, sample_size), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    }
+
+    if (supersample)
+    {
+      cv::pyrDown(supersampled, patch, cv::Size(kPatchSize, kPatchSize));
+      // pyrDown centres patch pixel i on sample 2i instead of 2i + 0.5, a quarter patch pixel towards the origin.
+      origin -= cv::Point2f(0.25f / scale, 0.25f / scale);
+    }
+
+    cv::equalizeHist(patch, patch);
+
+    cv::Point2f tl((face.x - origin.x) * scale, (face.y - origin.y) * scale);
+    return cv::Rect(cvRound(tl.x), cvRound(tl.y), cvRound(face.width * scale), cvRound(face.height * scale));
+  }
+
+  static cv::Point2f PatchToImage(const cv::Point2f& p, const cv::Point2f& origin, float scale)
+  {
+    return cv::Point2f((p.x + 0.5f) / scale - 0.5f + origin.x, (p.y + 0.5f) / scale - 0.5f + origin.y);
+  }
+
   static cv::Mat MakeCameraMatrix(int w, int h)
   {
     cv::Mat K = cv::Mat::eye(3, 3, CV_64F);
@@ -14,7 +62,7 @@ namespace cvfd
     return K;
   }
 
-  FaceCV::FaceCV(const std::string& cascade_path, const std::string& lbf_model_path, int image_width, int image_height, int max_faces, int detect_every_n_frames, int downscale)
+  FaceCV::FaceCV(const std::string& cascade_path, const std::string& lbf_model_path, int image_width, int image_height, int max_faces, int detect_every_n_frames, int downscale, bool compact_landmarks)
     : camera_matrix_(MakeCameraMatrix(image_width, image_height))
     , dist_coeffs_(cv::Mat::zeros(5, 1, CV_64F))
     , img_w_(image_width)
@@ -26,8 +74,14 @@ namespace cvfd
   {
     face_cascade_.load(cascade_path);
 
-    facemark_ = cv::face::FacemarkLBF::create();
-    facemark_->loadModel(lbf_model_path);
+    if (compact_landmarks)
+      compact_lbf_ = LbfCompact::Load(lbf_model_path);
+
+    if (!compact_lbf_)
+    {
+      facemark_ = cv::face::FacemarkLBF::create();
+      facemark_->loadModel(lbf_model_path);
+    }
 
     object_points_.push_back(cv::Point3d(8.27412, 1.33849, 10.63490));
     object_points_.push_back(cv::Point3d(-8.27412, 1.33849, 10.63490));
@@ -57,7 +111,7 @@ namespace cvfd
     return camera_matrix_;
   }
 
-  FaceResult FaceCV::Process(const cv::Mat& bgr_frame)
+  FaceResult FaceCV::Process(const cv::Mat& frame)
   {
     frame_counter_++;
     if (detect_every_n_frames_ > 1 && (frame_counter_ % detect_every_n_frames_) != 0)
@@ -65,24 +119,34 @@ namespace cvfd
 
     last_result_.faces.clear();
 
-    if (bgr_frame.empty())
+    if (frame.empty())
       return last_result_;
 
-    cv::Mat gray;
-    cv::cvtColor(bgr_frame, gray, cv::COLOR_BGR2GRAY);
-    cv::equalizeHist(gray, gray);
+    // Gray input is used as is and may be a view of a capture buffer, so it is never written to.
+    cv::Mat gray = frame;
+    if (frame.channels() != 1)
+    {
+      cv::cvtColor(frame, gray_, cv::COLOR_BGR2GRAY);
+      gray = gray_;
+    }
 
-    cv::Mat gray_small = gray;
+    // Only the detector input is equalized here, landmark patches get their own equalization below. At downscale 1
+    // that is still a full-resolution pass, so rl_face_tracker detects on a half-size image.
     float scale_up = 1.0f;
 
     if (downscale_ > 1)
     {
-      cv::resize(gray, gray_small, cv::Size(gray.cols / downscale_, gray.rows / downscale_), 0, 0, cv::INTER_LINEAR);
+      cv::resize(gray, detect_gray_, cv::Size(gray.cols / downscale_, gray.rows / downscale_), 0, 0, cv::INTER_LINEAR);
+      cv::equalizeHist(detect_gray_, detect_gray_);
       scale_up = (float)downscale_;
     }
+    else
+    {
+      cv::equalizeHist(gray, detect_gray_);
+    }
 
     std::vector<cv::Rect> faces_small;
-    face_cascade_.detectMultiScale(gray_small, faces_small, 1.1, 2, 0, cv::Size(30 / downscale_, 30 / downscale_));
+    face_cascade_.detectMultiScale(detect_gray_, faces_small, 1.1, 2, 0, cv::Size(30 / downscale_, 30 / downscale_));
 
     if (faces_small.empty())
       return last_result_;
@@ -111,15 +175,50 @@ namespace cvfd
     if ((int)faces.size() > max_faces_)
       faces.resize(max_faces_);
 
-    std::vector<std::vector<cv::Point2f>> landmarks;
+    if ((int)patch_pool_.size() < (int)faces.size())
+      patch_pool_.resize(faces.size());
+
+    std::vector<std::vector<cv::Point2f>> landmarks(faces.size());
     bool ok = false;
-    try
-    {
-      ok = facemark_->fit(gray, faces, landmarks);
-    }
-    catch (...)
+    for (size_t i = 0; i < faces.size(); i++)
     {
-      ok = false;
+      cv::Point2f origin;
+      float patch_scale = 1.0f;
+      cv::Rect patch_face = ExtractFacePatch(gray, faces[i], patch_pool_[i], supersampled_, origin, patch_scale);
+
+      std::vector<cv::Point2f>& lm = landmarks[i];
+      bool fit_ok = false;
+      if (compact_lbf_)
+      {
+        fit_ok = compact_lbf_->Fit(patch_pool_[i], patch_face, lm);
+      }
+      else
+      {
+        std::vector<cv::Rect> patch_faces(1, patch_face);
+        std::vector<std::vector<cv::Point2f>> patch_landmarks;
+        try
+        {
+          fit_ok = facemark_->fit(patch_pool_[i], patch_faces, patch_landmarks) && !patch_landmarks.empty();
+        }
+        catch (...)
+        {
+          fit_ok = false;
+        }
+
+        if (fit_ok)
+          lm.swap(patch_landmarks[0]);
+      }
+
+      if (!fit_ok)
+      {
+        lm.clear();
+        continue;
+      }
+
+      for (auto& p : lm)
+        p = PatchToImage(p, origin, patch_scale);
+
+      ok = true;
     }
 
     if (!ok || landmarks.empty())
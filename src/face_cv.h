@@ -1,10 +1,12 @@
 #ifndef FACE_CV_H
 #define FACE_CV_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include <opencv2/face.hpp>
+#include "lbf_compact.h"
 
 namespace cvfd
 {
@@ -25,9 +27,10 @@ namespace cvfd
   class FaceCV
   {
   public:
-    FaceCV(const std::string& cascade_path, const std::string& lbf_model_path, int image_width, int image_height, int max_faces, int detect_every_n_frames, int downscale);
+    FaceCV(const std::string& cascade_path, const std::string& lbf_model_path, int image_width, int image_height, int max_faces, int detect_every_n_frames, int downscale, bool compact_landmarks);
 
-    FaceResult Process(const cv::Mat& bgr_frame);
+    // Accepts a BGR frame or an 8-bit gray frame, the latter skips the color conversion.
+    FaceResult Process(const cv::Mat& frame);
 
     int ImageWidth() const;
     int ImageHeight() const;
@@ -37,6 +40,7 @@ namespace cvfd
   private:
     cv::CascadeClassifier face_cascade_;
     cv::Ptr<cv::face::Facemark> facemark_;
+    std::shared_ptr<const LbfCompact> compact_lbf_;
 
     cv::Mat camera_matrix_;
     cv::Mat dist_coeffs_;
@@ -53,6 +57,11 @@ namespace cvfd
     int frame_counter_;
 
     FaceResult last_result_;
+
+    cv::Mat gray_;
+    cv::Mat detect_gray_;
+    std::vector<cv::Mat> patch_pool_;
+    cv::Mat supersampled_;
   };
 } // namespace cvfd
 
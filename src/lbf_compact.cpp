@@ -0,0 +1,444 @@
+#include "lbf_compact.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/version.hpp>
+
+namespace
+{
+  constexpr uint32_t kBinaryMagic = 0x4346424C; // "LBFC"
+  constexpr uint32_t kBinaryVersion = 2;
+
+  // FacemarkLBF estimates the scale from calcCovarMatrix(COVAR_COLS) over the centered (x, y) columns,
+  // which reduces to the norm of half the x - y difference. Kept identical so the trees see the same samples.
+  void SimilarityTransform(const std::vector<double>& shape, const std::vector<double>& mean, int n, double& scale, double& cos_t, double& sin_t)
+  {
+    double cx1 = 0.0, cy1 = 0.0, cx2 = 0.0, cy2 = 0.0;
+    for (int i = 0; i < n; i++)
+    {
+      cx1 += shape[2 * i];
+      cy1 += shape[2 * i + 1];
+      cx2 += mean[2 * i];
+      cy2 += mean[2 * i + 1];
+    }
+    cx1 /= n;
+    cy1 /= n;
+    cx2 /= n;
+    cy2 /= n;
+
+    double d1 = 0.0, d2 = 0.0, num = 0.0, den = 0.0;
+    for (int i = 0; i < n; i++)
+    {
+      double x1 = shape[2 * i] - cx1;
+      double y1 = shape[2 * i + 1] - cy1;
+      double x2 = mean[2 * i] - cx2;
+      double y2 = mean[2 * i + 1] - cy2;
+
+      double h1 = (x1 - y1) * 0.5;
+      double h2 = (x2 - y2) * 0.5;
+      d1 += h1 * h1;
+      d2 += h2 * h2;
+
+      num += y1 * x2 - x1 * y2;
+      den += x1 * x2 + y1 * y2;
+    }
+
+    double s1 = std::sqrt(2.0 * d1);
+    double s2 = std::sqrt(2.0 * d2);
+    scale = (s2 > 0.0) ? s1 / s2 : 1.0;
+
+    double norm = std::sqrt(num * num + den * den);
+    cos_t = (norm > 0.0) ? den / norm : 1.0;
+    sin_t = (norm > 0.0) ? num / norm : 0.0;
+  }
+
+  // Adds the quantized outputs of one active leaf. This is the bulk of the per-stage work: every tree
+  // contributes a full column of 2 * landmark_n weights.
+  void AccumulateLeaf(const int8_t* col, int n, int32_t* acc)
+  {
+    int r = 0;
+#if CV_SIMD && !CV_SIMD_SCALABLE
+    const int lanes = CV_SIMD_WIDTH;
+    const int quarter = lanes / 4;
+    for (; r + lanes <= n; r += lanes)
+    {
+      cv::v_int16 w0, w1;
+      cv::v_expand(cv::vx_load(col + r), w0, w1);
+
+      cv::v_int32 a0, a1, a2, a3;
+      cv::v_expand(w0, a0, a1);
+      cv::v_expand(w1, a2, a3);
+
+#if CV_VERSION_MAJOR >= 5
+      cv::v_store(acc + r, cv::v_add(cv::vx_load(acc + r), a0));
+      cv::v_store(acc + r + quarter, cv::v_add(cv::vx_load(acc + r + quarter), a1));
+      cv::v_store(acc + r + 2 * quarter, cv::v_add(cv::vx_load(acc + r + 2 * quarter), a2));
+      cv::v_store(acc + r + 3 * quarter, cv::v_add(cv::vx_load(acc + r + 3 * quarter), a3));
+#else
+      cv::v_store(acc + r, cv::vx_load(acc + r) + a0);
+      cv::v_store(acc + r + quarter, cv::vx_load(acc + r + quarter) + a1);
+      cv::v_store(acc + r + 2 * quarter, cv::vx_load(acc + r + 2 * quarter) + a2);
+      cv::v_store(acc + r + 3 * quarter, cv::vx_load(acc + r + 3 * quarter) + a3);
+#endif
+    }
+#endif
+    for (; r < n; r++)
+      acc[r] += col[r];
+  }
+
+  template <typename T>
+  void WriteVec(std::ofstream& os, const std::vector<T>& v)
+  {
+    uint64_t n = v.size();
+    os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    os.write(reinterpret_cast<const char*>(v.data()), (std::streamsize)(n * sizeof(T)));
+  }
+
+  template <typename T>
+  bool ReadVec(std::ifstream& is, std::vector<T>& v, uint64_t expected)
+  {
+    uint64_t n = 0;
+    is.read(reinterpret_cast<char*>(&n), sizeof(n));
+    if (!is || n != expected)
+      return false;
+    v.resize(n);
+    is.read(reinterpret_cast<char*>(v.data()), (std::streamsize)(n * sizeof(T)));
+    return (bool)is;
+  }
+} // namespace
+
+namespace cvfd
+{
+  LbfCompact::LbfCompact()
+    : stages_n_(0)
+    , tree_n_(0)
+    , tree_depth_(0)
+    , landmark_n_(0)
+  {
+  }
+
+  std::shared_ptr<const LbfCompact> LbfCompact::Load(const std::string& path)
+  {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const LbfCompact>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::shared_ptr<const LbfCompact> cached = cache[path].lock();
+    if (cached)
+      return cached;
+
+    std::shared_ptr<LbfCompact> model(new LbfCompact());
+
+    bool ok = (std::filesystem::path(path).extension() == ".lbfc") ? model->ReadBinary(path) : model->ReadYaml(path);
+    if (!ok)
+    {
+      std::cerr << "Could not load compact LBF model from " << path << "\n";
+      return nullptr;
+    }
+
+    cache[path] = model;
+    return model;
+  }
+
+  bool LbfCompact::ReadYaml(const std::string& path)
+  {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened())
+      return false;
+
+    fs["stages_n"] >> stages_n_;
+    fs["tree_n"] >> tree_n_;
+    fs["tree_depth"] >> tree_depth_;
+    fs["n_landmarks"] >> landmark_n_;
+
+    if (stages_n_ <= 0 || tree_n_ <= 0 || tree_depth_ < 2 || landmark_n_ <= 0)
+      return false;
+
+    cv::Mat mean;
+    fs["regressor_meanshape"] >> mean;
+    if (mean.rows != landmark_n_ || mean.cols != 2)
+      return false;
+    mean.convertTo(mean, CV_64F);
+
+    mean_shape_.resize(2 * landmark_n_);
+    for (int i = 0; i < landmark_n_; i++)
+    {
+      mean_shape_[2 * i] = mean.at<double>(i, 0);
+      mean_shape_[2 * i + 1] = mean.at<double>(i, 1);
+    }
+
+    const int leaves = 1 << (tree_depth_ - 1);
+    const int inner = leaves - 1;
+    const int trees = landmark_n_ * tree_n_;
+    const int outputs = 2 * landmark_n_;
+    const int features = trees * leaves;
+
+    stages_.resize(stages_n_);
+    for (int k = 0; k < stages_n_; k++)
+    {
+      Stage& st = stages_[k];
+      st.x1.resize((size_t)trees * inner);
+      st.y1.resize((size_t)trees * inner);
+      st.x2.resize((size_t)trees * inner);
+      st.y2.resize((size_t)trees * inner);
+      st.thresholds.resize((size_t)trees * inner);
+
+      for (int i = 0; i < landmark_n_; i++)
+      {
+        for (int j = 0; j < tree_n_; j++)
+        {
+          cv::Mat feats;
+          std::vector<int> thresholds;
+          fs[cv::format("tree_%d_%d_%d", k, i, j)] >> feats;
+          fs[cv::format("thresholds_%d_%d_%d", k, i, j)] >> thresholds;
+
+          if (feats.rows < leaves || feats.cols != 4 || (int)thresholds.size() < leaves)
+            return false;
+          feats.convertTo(feats, CV_64F);
+
+          // Heap order (root at 1, children at 2i and 2i+1) is already breadth-first, node idx lands at idx - 1.
+          size_t base = (size_t)(i * tree_n_ + j) * inner;
+          for (int idx = 1; idx < leaves; idx++)
+          {
+            size_t n = base + idx - 1;
+            st.x1[n] = (float)feats.at<double>(idx, 0);
+            st.y1[n] = (float)feats.at<double>(idx, 1);
+            st.x2[n] = (float)feats.at<double>(idx, 2);
+            st.y2[n] = (float)feats.at<double>(idx, 3);
+            st.thresholds[n] = cv::saturate_cast<int16_t>(thresholds[idx]);
+          }
+        }
+      }
+
+      cv::Mat w;
+      fs[cv::format("weights_%d", k)] >> w;
+      if (w.rows != outputs || w.cols != features)
+        return false;
+      w.convertTo(w, CV_64F);
+
+      // Symmetric per-output quantization, stored leaf-major: column f holds all outputs of leaf feature f.
+      st.weights.resize((size_t)features * outputs);
+      st.weight_scales.resize(outputs);
+      for (int r = 0; r < outputs; r++)
+      {
+        const double* row = w.ptr<double>(r);
+        double max_abs = 0.0;
+        for (int f = 0; f < features; f++)
+          max_abs = std::max(max_abs, std::abs(row[f]));
+
+        double s = (max_abs > 0.0) ? max_abs / 127.0 : 1.0;
+        st.weight_scales[r] = (float)s;
+
+        for (int f = 0; f < features; f++)
+          st.weights[(size_t)f * outputs + r] = (int8_t)cvRound(row[f] / s);
+      }
+    }
+
+    return true;
+  }
+
+  bool LbfCompact::ReadBinary(const std::string& path)
+  {
+    std::ifstream is(path, std::ios::binary);
+    if (!is)
+      return false;
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    int32_t dims[4] = {0, 0, 0, 0};
+    is.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    is.read(reinterpret_cast<char*>(&version), sizeof(version));
+    is.read(reinterpret_cast<char*>(dims), sizeof(dims));
+    if (!is || magic != kBinaryMagic || version != kBinaryVersion)
+      return false;
+
+    stages_n_ = dims[0];
+    tree_n_ = dims[1];
+    tree_depth_ = dims[2];
+    landmark_n_ = dims[3];
+    if (stages_n_ <= 0 || tree_n_ <= 0 || tree_depth_ < 2 || tree_depth_ > 16 || landmark_n_ <= 0)
+      return false;
+
+    const uint64_t leaves = 1ull << (tree_depth_ - 1);
+    const uint64_t nodes = (uint64_t)landmark_n_ * tree_n_ * (leaves - 1);
+    const uint64_t outputs = 2ull * landmark_n_;
+    const uint64_t features = (uint64_t)landmark_n_ * tree_n_ * leaves;
+
+    if (!ReadVec(is, mean_shape_, outputs))
+      return false;
+
+    stages_.resize(stages_n_);
+    for (Stage& st : stages_)
+    {
+      bool ok = ReadVec(is, st.x1, nodes) && ReadVec(is, st.y1, nodes) && ReadVec(is, st.x2, nodes) && ReadVec(is, st.y2, nodes) && ReadVec(is, st.thresholds, nodes) && ReadVec(is, st.weights, features * outputs) && ReadVec(is, st.weight_scales, outputs);
+      if (!ok)
+        return false;
+    }
+
+    return true;
+  }
+
+  bool LbfCompact::Save(const std::string& path) const
+  {
+    std::ofstream os(path, std::ios::binary);
+    if (!os)
+      return false;
+
+    int32_t dims[4] = {stages_n_, tree_n_, tree_depth_, landmark_n_};
+    os.write(reinterpret_cast<const char*>(&kBinaryMagic), sizeof(kBinaryMagic));
+    os.write(reinterpret_cast<const char*>(&kBinaryVersion), sizeof(kBinaryVersion));
+    os.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+
+    WriteVec(os, mean_shape_);
+    for (const Stage& st : stages_)
+    {
+      WriteVec(os, st.x1);
+      WriteVec(os, st.y1);
+      WriteVec(os, st.x2);
+      WriteVec(os, st.y2);
+      WriteVec(os, st.thresholds);
+      WriteVec(os, st.weights);
+      WriteVec(os, st.weight_scales);
+    }
+
+    return (bool)os;
+  }
+
+  int LbfCompact::LandmarkCount() const
+  {
+    return landmark_n_;
+  }
+
+  size_t LbfCompact::MemoryBytes() const
+  {
+    size_t bytes = sizeof(*this) + mean_shape_.size() * sizeof(double);
+    for (const Stage& st : stages_)
+    {
+      bytes += (st.x1.size() + st.y1.size() + st.x2.size() + st.y2.size()) * sizeof(float);
+      bytes += st.thresholds.size() * sizeof(int16_t);
+      bytes += st.weights.size() * sizeof(int8_t);
+      bytes += st.weight_scales.size() * sizeof(float);
+    }
+    return bytes;
+  }
+
+  bool LbfCompact::Fit(const cv::Mat& gray, const cv::Rect& face, std::vector<cv::Point2f>& out_landmarks) const
+  {
+    out_landmarks.clear();
+
+    if (gray.empty() || gray.type() != CV_8UC1 || face.width <= 0 || face.height <= 0 || stages_.empty())
+      return false;
+
+    // FacemarkLBF fits inside the face box grown by half its size, clipped to the image. Shapes are kept in
+    // coordinates of that crop and in double, the way FacemarkLBF computes them, so every split truncates to
+    // the same pixel.
+    int min_x = std::max(0, face.x - face.width / 2);
+    int min_y = std::max(0, face.y - face.height / 2);
+    int max_x = std::min(gray.cols - 1, face.x + face.width + face.width / 2);
+    int max_y = std::min(gray.rows - 1, face.y + face.height + face.height / 2);
+    if (max_x <= min_x || max_y <= min_y)
+      return false;
+
+    const double x_hi = (double)(max_x - min_x - 1);
+    const double y_hi = (double)(max_y - min_y - 1);
+
+    const double box_cx = (face.x - min_x) + face.width / 2.0;
+    const double box_cy = (face.y - min_y) + face.height / 2.0;
+    const double box_sx = face.width / 2.0;
+    const double box_sy = face.height / 2.0;
+
+    const int leaves = 1 << (tree_depth_ - 1);
+    const int inner = leaves - 1;
+    const int trees = landmark_n_ * tree_n_;
+    const int outputs = 2 * landmark_n_;
+
+    thread_local std::vector<double> shape;
+    thread_local std::vector<double> projected;
+    thread_local std::vector<int32_t> acc;
+    thread_local std::vector<const int8_t*> leaf_cols;
+
+    shape.resize(outputs);
+    projected.resize(outputs);
+    acc.resize(outputs);
+    leaf_cols.resize(trees);
+
+    for (int i = 0; i < landmark_n_; i++)
+    {
+      shape[2 * i] = mean_shape_[2 * i] * box_sx + box_cx;
+      shape[2 * i + 1] = mean_shape_[2 * i + 1] * box_sy + box_cy;
+    }
+
+    for (const Stage& st : stages_)
+    {
+      for (int i = 0; i < landmark_n_; i++)
+      {
+        projected[2 * i] = (shape[2 * i] - box_cx) / box_sx;
+        projected[2 * i + 1] = (shape[2 * i + 1] - box_cy) / box_sy;
+      }
+
+      double scale, c, s;
+      SimilarityTransform(projected, mean_shape_, landmark_n_, scale, c, s);
+
+      for (int i = 0; i < landmark_n_; i++)
+      {
+        const double cur_x = shape[2 * i];
+        const double cur_y = shape[2 * i + 1];
+
+        for (int j = 0; j < tree_n_; j++)
+        {
+          const int tr = i * tree_n_ + j;
+          const size_t base = (size_t)tr * inner;
+
+          // Only the depth - 1 nodes on the path are transformed, with the same similarity transform and
+          // operation order as FacemarkLBF's generateLBF.
+          int idx = 1;
+          while (idx < leaves)
+          {
+            size_t n = base + idx - 1;
+
+            double x1 = scale * (c * st.x1[n] - s * st.y1[n]);
+            double y1 = scale * (s * st.x1[n] + c * st.y1[n]);
+            double x2 = scale * (c * st.x2[n] - s * st.y2[n]);
+            double y2 = scale * (s * st.x2[n] + c * st.y2[n]);
+
+            x1 = std::max(0.0, std::min(x_hi, x1 * box_sx + cur_x));
+            y1 = std::max(0.0, std::min(y_hi, y1 * box_sy + cur_y));
+            x2 = std::max(0.0, std::min(x_hi, x2 * box_sx + cur_x));
+            y2 = std::max(0.0, std::min(y_hi, y2 * box_sy + cur_y));
+
+            int density = (int)gray.ptr<uchar>(min_y + (int)y1)[min_x + (int)x1] - (int)gray.ptr<uchar>(min_y + (int)y2)[min_x + (int)x2];
+            idx = 2 * idx + ((density < st.thresholds[n]) ? 0 : 1);
+          }
+
+          leaf_cols[tr] = &st.weights[((size_t)tr * leaves + (idx - leaves)) * outputs];
+        }
+      }
+
+      // Weight columns are scattered over the whole stage and mostly miss the cache. Gathering them after all
+      // walks leaves only independent loads here, so the misses overlap instead of stalling each walk.
+      std::fill(acc.begin(), acc.end(), 0);
+      for (int tr = 0; tr < trees; tr++)
+        AccumulateLeaf(leaf_cols[tr], outputs, acc.data());
+
+      for (int i = 0; i < landmark_n_; i++)
+      {
+        double dx = scale * (acc[2 * i] * (double)st.weight_scales[2 * i]);
+        double dy = scale * (acc[2 * i + 1] * (double)st.weight_scales[2 * i + 1]);
+        shape[2 * i] = (projected[2 * i] + (c * dx - s * dy)) * box_sx + box_cx;
+        shape[2 * i + 1] = (projected[2 * i + 1] + (s * dx + c * dy)) * box_sy + box_cy;
+      }
+    }
+
+    out_landmarks.resize(landmark_n_);
+    for (int i = 0; i < landmark_n_; i++)
+      out_landmarks[i] = cv::Point2f((float)(shape[2 * i] + min_x), (float)(shape[2 * i + 1] + min_y));
+
+    return true;
+  }
+} // namespace cvfd
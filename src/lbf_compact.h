@@ -0,0 +1,57 @@
+#ifndef LBF_COMPACT_H
+#define LBF_COMPACT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace cvfd
+{
+  // Landmark regressor running the trained FacemarkLBF model from a compact layout: split nodes packed
+  // breadth-first per tree in contiguous per-stage arrays, global regression weights quantized to int8
+  // and stored leaf-major so every active leaf adds one contiguous column. Instances built from the same
+  // file share one immutable model.
+  class LbfCompact
+  {
+  public:
+    // Accepts the OpenCV lbfmodel.yaml (converted on load) or a file written by Save.
+    static std::shared_ptr<const LbfCompact> Load(const std::string& path);
+
+    bool Save(const std::string& path) const;
+
+    // Same crop and coordinate conventions as FacemarkLBF::fit for a single face rectangle.
+    bool Fit(const cv::Mat& gray, const cv::Rect& face, std::vector<cv::Point2f>& out_landmarks) const;
+
+    int LandmarkCount() const;
+    size_t MemoryBytes() const;
+
+  private:
+    struct Stage
+    {
+      std::vector<float> x1;
+      std::vector<float> y1;
+      std::vector<float> x2;
+      std::vector<float> y2;
+      std::vector<int16_t> thresholds;
+      std::vector<int8_t> weights;
+      std::vector<float> weight_scales;
+    };
+
+    LbfCompact();
+
+    bool ReadYaml(const std::string& path);
+    bool ReadBinary(const std::string& path);
+
+    int stages_n_;
+    int tree_n_;
+    int tree_depth_;
+    int landmark_n_;
+
+    std::vector<double> mean_shape_;
+    std::vector<Stage> stages_;
+  };
+} // namespace cvfd
+
+#endif // LBF_COMPACT_H
@@ -1,27 +1,72 @@
 #include "camera_handler.h"
+#include "debug_overlay.h"
 #include "face_cv.h"
 #include "raylib_utils.h"
+#include "render_scheduler.h"
 #include "rlights.h"
+#include "v4l2_capture.h"
 #include <raylib.h>
 #include <rlgl.h>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#ifdef RLFT_HAVE_POSE_SHM
+#include "pose_publisher.h"
+#endif
 
 int main(int argc, char** argv)
 {
   std::filesystem::path cascade_path = rlft::AssetPath("haarcascade_frontalface_default.xml");
   std::filesystem::path lbf_path = rlft::AssetPath("lbfmodel.yaml");
 
-  camh::CameraHandler cam(0, 1280, 720, 30);
+  std::string publish_name;
+  bool compact_lbf = false;
+  std::string v4l2_device;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--publish" && i + 1 < argc)
+      publish_name = argv[++i];
+    else if (arg == "--compact-lbf")
+      compact_lbf = true;
+    else if (arg == "--v4l2" && i + 1 < argc)
+      v4l2_device = argv[++i];
+  }
+
+#ifdef RLFT_HAVE_POSE_SHM
+  std::unique_ptr<pshm::Writer> publisher;
+  if (!publish_name.empty())
+  {
+    publisher = std::make_unique<pshm::Writer>(publish_name);
+    if (!publisher->IsOpen())
+      return 1;
+  }
+#else
+  if (!publish_name.empty())
+  {
+    std::cerr << "--publish needs POSIX shared memory, which is not available in this build\n";
+    return 1;
+  }
+#endif
+
+  std::unique_ptr<camh::CameraHandler> cam_ptr;
+  if (v4l2_device.empty())
+    cam_ptr = std::make_unique<camh::CameraHandler>(0, 1280, 720, 30);
+  else
+    cam_ptr = std::make_unique<camh::CameraHandler>(v4l2_device, 1280, 720, 30);
+
+  camh::CameraHandler& cam = *cam_ptr;
   if (!cam.IsOpened())
     return 1;
 
   int img_w = cam.Width();
   int img_h = cam.Height();
 
-  cvfd::FaceCV face(cascade_path.string(), lbf_path.string(), img_w, img_h, 5, 1, 1);
+  cvfd::FaceCV face(cascade_path.string(), lbf_path.string(), img_w, img_h, 5, 1, 2, compact_lbf);
 
   SetConfigFlags(FLAG_WINDOW_RESIZABLE);
   InitWindow(img_w, img_h, "Raylib Face Tracker");
-  SetTargetFPS(60);
 
   Image img = GenImageColor(img_w, img_h, BLACK);
   Texture2D tex = LoadTextureFromImage(img);
@@ -40,7 +85,7 @@ int main(int argc, char** argv)
 
   Light light = CreateLight(LIGHT_DIRECTIONAL, (Vector3){0.0f, 0.0f, 0.0f}, (Vector3){0.3f, -0.7f, 1.0f}, WHITE, light_shader);
 
-  cv::Mat frame_bgr;
+  cv::Mat frame_gray;
   cv::Mat frame_rgba;
 
   Camera3D cv_cam = rlft::MakeOpenCVCamera(face.CameraMatrix(), img_w, img_h);
@@ -49,79 +94,121 @@ int main(int argc, char** argv)
   bool do_cv = true;
 
   cvfd::FaceResult fr;
+  rlft::DebugOverlay overlay;
+  rlft::RenderScheduler sched(cam.Fps());
+
+  uint64_t frame_id = 0;
+  uint64_t capture_ns = 0;
+  double cv_ms = 0.0;
 
   while (!WindowShouldClose())
   {
     if (IsKeyPressed(KEY_ONE))
+    {
       show_debug = !show_debug;
+      sched.Invalidate();
+    }
 
     if (IsKeyPressed(KEY_TWO))
+    {
       do_cv = !do_cv;
+      sched.Invalidate();
+    }
+
+    if (IsWindowResized())
+      sched.Invalidate();
 
-    if (cam.Read(frame_bgr))
+    if (cam.ReadFrame(frame_rgba, frame_gray, capture_ns))
     {
-      cv::cvtColor(frame_bgr, frame_rgba, cv::COLOR_BGR2RGBA);
-      UpdateTexture(tex, frame_rgba.data);
+      frame_id++;
 
-      float scale, off_x, off_y, draw_w, draw_h;
-      rlft::DrawWebcamTexture(tex, img_w, img_h, scale, off_x, off_y, draw_w, draw_h);
+      UpdateTexture(tex, frame_rgba.data);
+      sched.NotifyFrame();
 
       if (do_cv)
       {
-        fr = face.Process(frame_bgr);
+        double t0 = GetTime();
+        fr = face.Process(frame_gray);
+        cv_ms = (GetTime() - t0) * 1000.0;
+
+#ifdef RLFT_HAVE_POSE_SHM
+        if (publisher)
+          pshm::PublishFaceResult(*publisher, fr, frame_id, capture_ns, img_w, img_h);
+#endif
+      }
+    }
+
+    if (!sched.ShouldPresent())
+    {
+      sched.Idle();
+      continue;
+    }
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+
+    float scale, off_x, off_y, draw_w, draw_h;
+    rlft::DrawWebcamTexture(tex, img_w, img_h, scale, off_x, off_y, draw_w, draw_h);
+
+    if (do_cv)
+    {
+      BeginScissorMode((int)off_x, (int)off_y, (int)draw_w, (int)draw_h);
+      rlViewport((int)off_x, (int)off_y, (int)draw_w, (int)draw_h);
+
+      BeginMode3D(cv_cam);
+
+      Vector3 vp = cv_cam.position;
+      SetShaderValue(light_shader, loc_view_pos, &vp.x, SHADER_UNIFORM_VEC3);
+
+      UpdateLightValues(light_shader, light);
+
+      for (size_t fi = 0; fi < fr.faces.size(); fi++)
+      {
+        const auto& fp = fr.faces[fi];
+        rlft::DrawModelAtPoseLit(glasses_model, fp.rvec, fp.tvec);
+      }
 
-        BeginScissorMode((int)off_x, (int)off_y, (int)draw_w, (int)draw_h);
-        rlViewport((int)off_x, (int)off_y, (int)draw_w, (int)draw_h);
+      EndMode3D();
 
-        BeginMode3D(cv_cam);
+      rlViewport(0, 0, GetScreenWidth(), GetScreenHeight());
+      EndScissorMode();
+    }
 
-        Vector3 vp = cv_cam.position;
-        SetShaderValue(light_shader, loc_view_pos, &vp.x, SHADER_UNIFORM_VEC3);
+    if (show_debug)
+    {
+      rlft::RenderScheduler::Stats st = sched.GetStats();
 
-        UpdateLightValues(light_shader, light);
+      overlay.Begin(scale, off_x, off_y);
 
+      if (do_cv)
+      {
         for (size_t fi = 0; fi < fr.faces.size(); fi++)
         {
           const auto& fp = fr.faces[fi];
-          rlft::DrawModelAtPoseLit(glasses_model, fp.rvec, fp.tvec);
-
-          if (show_debug)
-            rlft::DrawAxisBarsAtPose(fp.rvec, fp.tvec, 15.0f, 1.0f);
+          overlay.AddFace(fp);
+          overlay.AddText(rlft::DebugOverlay::Layer::Image, {(float)fp.bbox.x, (float)fp.bbox.y - 18.0f / scale}, TextFormat("#%d", (int)fi), 16.0f, RED);
         }
 
-        EndMode3D();
+        overlay.AddText(rlft::DebugOverlay::Layer::Screen, {10.0f, 60.0f}, TextFormat("cv %.1f ms, %d faces", cv_ms, (int)fr.faces.size()), 20.0f, GREEN);
+      }
 
-        rlViewport(0, 0, GetScreenWidth(), GetScreenHeight());
-        EndScissorMode();
+      overlay.AddText(rlft::DebugOverlay::Layer::Screen, {10.0f, 85.0f}, TextFormat("presented %lld (%lld on events), avoided %lld vs 60 Hz, idle %.1f s", st.presented, st.on_event, st.avoided, st.idle_seconds), 20.0f, GREEN);
 
-        if (show_debug)
-        {
-          for (size_t fi = 0; fi < fr.faces.size(); fi++)
-          {
-            const auto& fp = fr.faces[fi];
-
-            Vector2 p1 = rlft::MapToWindow({(float)fp.bbox.x, (float)fp.bbox.y}, scale, off_x, off_y);
-            Vector2 p2 = rlft::MapToWindow({(float)(fp.bbox.x + fp.bbox.width), (float)(fp.bbox.y + fp.bbox.height)}, scale, off_x, off_y);
-
-            DrawRectangleLines((int)p1.x, (int)p1.y, (int)(p2.x - p1.x), (int)(p2.y - p1.y), RED);
-            DrawRectangleLines((int)p1.x, (int)p1.y, (int)(p2.x - p1.x), (int)(p2.y - p1.y), RED);
-
-            for (size_t i = 0; i < fp.landmarks_68.size(); i++)
-            {
-              Vector2 p = rlft::MapToWindow(fp.landmarks_68[i], scale, off_x, off_y);
-              DrawCircleV(p, 2.0f, YELLOW);
-            }
-          }
-        }
-      }
+      if (const camh::V4L2Stats* vs = cam.CaptureStats())
+        overlay.AddText(rlft::DebugOverlay::Layer::Screen, {10.0f, 110.0f}, TextFormat("v4l2 %d buffers, latency %.2f ms (avg %.2f, max %.2f), dropped %llu, errors %llu", vs->buffer_count, vs->last_latency_ms, vs->avg_latency_ms, vs->max_latency_ms, (unsigned long long)vs->dropped, (unsigned long long)vs->errors), 20.0f, GREEN);
+      overlay.Draw();
     }
 
     DrawText(TextFormat("Press 1 to toggle debug info (%s)", show_debug ? "ON" : "OFF"), 10, 10, 20, GREEN);
     DrawText(TextFormat("Press 2 to toggle cv computations (%s)", do_cv ? "ON" : "OFF"), 10, 35, 20, GREEN);
 
     EndDrawing();
+    sched.Presented();
   }
 
+  rlft::RenderScheduler::Stats st = sched.GetStats();
+  std::cerr << "Frames presented=" << st.presented << " on_event=" << st.on_event << " avoided_vs_60hz=" << st.avoided << " idle_s=" << st.idle_seconds << "\n";
+
   UnloadShader(light_shader);
   UnloadModel(glasses_model);
   UnloadTexture(tex);
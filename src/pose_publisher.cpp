@@ -0,0 +1,56 @@
+#include "pose_publisher.h"
+#include <algorithm>
+
+namespace pshm
+{
+  void PublishFaceResult(Writer& writer, const cvfd::FaceResult& fr, uint64_t frame_id, uint64_t capture_ns, int image_width, int image_height)
+  {
+    if (!writer.IsOpen())
+      return;
+
+    FrameRecord& rec = writer.BeginWrite();
+
+    int count = std::min((int)fr.faces.size(), kMaxFaces);
+
+    rec.frame_id = frame_id;
+    rec.capture_ns = capture_ns;
+    rec.image_width = (uint32_t)image_width;
+    rec.image_height = (uint32_t)image_height;
+    rec.face_count = (uint32_t)count;
+    rec.reserved = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+      const cvfd::FacePose& fp = fr.faces[i];
+      FaceRecord& out = rec.faces[i];
+
+      out.id = (uint32_t)i;
+      out.bbox[0] = fp.bbox.x;
+      out.bbox[1] = fp.bbox.y;
+      out.bbox[2] = fp.bbox.width;
+      out.bbox[3] = fp.bbox.height;
+      out.reserved = 0;
+
+      int n = std::min((int)fp.landmarks_68.size(), kLandmarkCount);
+      for (int k = 0; k < n; k++)
+      {
+        out.landmarks[k][0] = fp.landmarks_68[k].x;
+        out.landmarks[k][1] = fp.landmarks_68[k].y;
+      }
+      for (int k = n; k < kLandmarkCount; k++)
+      {
+        out.landmarks[k][0] = 0.0f;
+        out.landmarks[k][1] = 0.0f;
+      }
+
+      for (int k = 0; k < 3; k++)
+      {
+        out.rvec[k] = fp.rvec[k];
+        out.tvec[k] = fp.tvec[k];
+      }
+    }
+
+    rec.publish_ns = NowNs();
+    writer.EndWrite();
+  }
+} // namespace pshm
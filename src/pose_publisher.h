@@ -0,0 +1,14 @@
+#ifndef POSE_PUBLISHER_H
+#define POSE_PUBLISHER_H
+
+#include <cstdint>
+#include "face_cv.h"
+#include "pose_shm.h"
+
+namespace pshm
+{
+  // Writes one FaceResult straight into the next ring slot. Faces beyond kMaxFaces are dropped.
+  void PublishFaceResult(Writer& writer, const cvfd::FaceResult& fr, uint64_t frame_id, uint64_t capture_ns, int image_width, int image_height);
+} // namespace pshm
+
+#endif // POSE_PUBLISHER_H
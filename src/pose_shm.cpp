@@ -0,0 +1,254 @@
+#include "pose_shm.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  std::string ShmName(const std::string& name)
+  {
+    if (!name.empty() && name[0] == '/')
+      return name;
+    return "/" + name;
+  }
+} // namespace
+
+namespace pshm
+{
+  uint64_t NowNs()
+  {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  Writer::Writer(const std::string& name)
+    : name_(ShmName(name))
+    , fd_(-1)
+    , region_(nullptr)
+    , next_(0)
+  {
+    // O_EXCL keeps the ring single-writer: a second publisher on the same name fails instead of interleaving slots.
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd_ < 0)
+    {
+      if (errno == EEXIST)
+        std::cerr << "Shared memory " << name_ << " already has a writer (remove /dev/shm" << name_ << " if it was left by a crashed run)\n";
+      else
+        std::cerr << "Could not create shared memory " << name_ << ": " << std::strerror(errno) << "\n";
+      return;
+    }
+
+    if (ftruncate(fd_, sizeof(Region)) != 0)
+    {
+      std::cerr << "Could not size shared memory " << name_ << ": " << std::strerror(errno) << "\n";
+      close(fd_);
+      shm_unlink(name_.c_str());
+      fd_ = -1;
+      return;
+    }
+
+    void* p = mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED)
+    {
+      std::cerr << "Could not map shared memory " << name_ << ": " << std::strerror(errno) << "\n";
+      close(fd_);
+      shm_unlink(name_.c_str());
+      fd_ = -1;
+      return;
+    }
+
+    region_ = static_cast<Region*>(p);
+
+    // Invalidate the header first so readers attached to a previous run stop trusting the slots.
+    region_->header.magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    region_->header.version = kVersion;
+    region_->header.slot_count = kSlotCount;
+    region_->header.slot_size = sizeof(Slot);
+    region_->header.max_faces = kMaxFaces;
+    region_->header.landmark_count = kLandmarkCount;
+    region_->header.head.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < kSlotCount; i++)
+      region_->slots[i].seq.store(0, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    region_->header.magic = kMagic;
+  }
+
+  Writer::~Writer()
+  {
+    if (region_)
+      munmap(region_, sizeof(Region));
+
+    if (fd_ >= 0)
+    {
+      close(fd_);
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  bool Writer::IsOpen() const
+  {
+    return region_ != nullptr;
+  }
+
+  FrameRecord& Writer::BeginWrite()
+  {
+    Slot& slot = region_->slots[next_ % kSlotCount];
+
+    // Odd sequence marks the slot as being written, readers that overlap it discard their copy.
+    slot.seq.store(2 * next_ + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return slot.frame;
+  }
+
+  void Writer::EndWrite()
+  {
+    Slot& slot = region_->slots[next_ % kSlotCount];
+
+    slot.seq.store(2 * next_ + 2, std::memory_order_release);
+    next_++;
+    region_->header.head.store(next_, std::memory_order_release);
+  }
+
+  Reader::Reader(const std::string& name)
+    : fd_(-1)
+    , region_(nullptr)
+    , cursor_(0)
+    , dropped_(0)
+  {
+    std::string shm_name = ShmName(name);
+
+    fd_ = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd_ < 0)
+    {
+      std::cerr << "Could not open shared memory " << shm_name << ": " << std::strerror(errno) << "\n";
+      return;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || (size_t)st.st_size < sizeof(Region))
+    {
+      std::cerr << "Shared memory " << shm_name << " is too small\n";
+      close(fd_);
+      fd_ = -1;
+      return;
+    }
+
+    void* p = mmap(nullptr, sizeof(Region), PROT_READ, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED)
+    {
+      std::cerr << "Could not map shared memory " << shm_name << ": " << std::strerror(errno) << "\n";
+      close(fd_);
+      fd_ = -1;
+      return;
+    }
+
+    const Region* region = static_cast<const Region*>(p);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    const Header& h = region->header;
+    if (h.magic != kMagic || h.version != kVersion || h.slot_count != (uint32_t)kSlotCount || h.slot_size != sizeof(Slot) || h.max_faces != (uint32_t)kMaxFaces || h.landmark_count != (uint32_t)kLandmarkCount)
+    {
+      std::cerr << "Shared memory " << shm_name << " has an incompatible layout\n";
+      munmap(p, sizeof(Region));
+      close(fd_);
+      fd_ = -1;
+      return;
+    }
+
+    region_ = region;
+    cursor_ = region_->header.head.load(std::memory_order_acquire);
+  }
+
+  Reader::~Reader()
+  {
+    if (region_)
+      munmap(const_cast<Region*>(region_), sizeof(Region));
+
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  bool Reader::IsOpen() const
+  {
+    return region_ != nullptr;
+  }
+
+  bool Reader::ReadIndex(uint64_t index, FrameRecord& out) const
+  {
+    const Slot& slot = region_->slots[index % kSlotCount];
+    uint64_t expected = 2 * index + 2;
+
+    uint64_t s1 = slot.seq.load(std::memory_order_acquire);
+    if (s1 != expected)
+      return false;
+
+    std::memcpy(&out, &slot.frame, sizeof(FrameRecord));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t s2 = slot.seq.load(std::memory_order_relaxed);
+
+    return s1 == s2;
+  }
+
+  bool Reader::ReadLatest(FrameRecord& out)
+  {
+    for (int attempt = 0; attempt < kSlotCount; attempt++)
+    {
+      uint64_t head = region_->header.head.load(std::memory_order_acquire);
+      if (head == 0)
+        return false;
+
+      if (ReadIndex(head - 1, out))
+      {
+        cursor_ = head;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool Reader::ReadNext(FrameRecord& out)
+  {
+    for (int attempt = 0; attempt < kSlotCount; attempt++)
+    {
+      uint64_t head = region_->header.head.load(std::memory_order_acquire);
+      if (head < cursor_)
+        cursor_ = 0; // writer restarted
+      if (cursor_ >= head)
+        return false;
+
+      if (head - cursor_ > (uint64_t)kSlotCount - 1)
+      {
+        uint64_t oldest = head - (kSlotCount - 1);
+        dropped_ += oldest - cursor_;
+        cursor_ = oldest;
+      }
+
+      if (ReadIndex(cursor_, out))
+      {
+        cursor_++;
+        return true;
+      }
+
+      // Slot got overwritten while copying, move past it.
+      dropped_++;
+      cursor_++;
+    }
+
+    return false;
+  }
+
+  uint64_t Reader::Dropped() const
+  {
+    return dropped_;
+  }
+} // namespace pshm
@@ -0,0 +1,122 @@
+#ifndef POSE_SHM_H
+#define POSE_SHM_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace pshm
+{
+  // Fixed binary layout of the face pose ring in POSIX shared memory. One writer fills slots in place,
+  // any number of readers validate each slot with its sequence counter (seqlock), no locks are taken.
+  constexpr uint32_t kMagic = 0x4D485350; // "PSHM"
+  constexpr uint32_t kVersion = 1;
+  constexpr int kMaxFaces = 8;
+  constexpr int kLandmarkCount = 68;
+  constexpr int kSlotCount = 8;
+
+  struct FaceRecord
+  {
+    uint32_t id;
+    int32_t bbox[4];
+    float landmarks[kLandmarkCount][2];
+    uint32_t reserved;
+    double rvec[3];
+    double tvec[3];
+  };
+
+  struct FrameRecord
+  {
+    uint64_t frame_id;
+    uint64_t capture_ns;
+    uint64_t publish_ns;
+    uint32_t image_width;
+    uint32_t image_height;
+    uint32_t face_count;
+    uint32_t reserved;
+    FaceRecord faces[kMaxFaces];
+  };
+
+  struct alignas(64) Slot
+  {
+    std::atomic<uint64_t> seq;
+    FrameRecord frame;
+  };
+
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t max_faces;
+    uint32_t landmark_count;
+    alignas(64) std::atomic<uint64_t> head;
+  };
+
+  struct Region
+  {
+    Header header;
+    Slot slots[kSlotCount];
+  };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory counters must be lock free");
+  static_assert(sizeof(FaceRecord) == 616, "FaceRecord layout changed");
+  static_assert(sizeof(FrameRecord) == 40 + kMaxFaces * sizeof(FaceRecord), "FrameRecord layout changed");
+
+  uint64_t NowNs();
+
+  // Creates the segment and removes it again on destruction. Fails if the name already exists, so only one
+  // writer can own a ring.
+  class Writer
+  {
+  public:
+    explicit Writer(const std::string& name);
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    bool IsOpen() const;
+
+    // Returns the slot to fill in place, valid until EndWrite.
+    FrameRecord& BeginWrite();
+    void EndWrite();
+
+  private:
+    std::string name_;
+    int fd_;
+    Region* region_;
+    uint64_t next_;
+  };
+
+  class Reader
+  {
+  public:
+    explicit Reader(const std::string& name);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    bool IsOpen() const;
+
+    // Most recent complete frame. Returns false if nothing was published yet.
+    bool ReadLatest(FrameRecord& out);
+
+    // Next frame after the last one returned, skipping ahead if the writer lapped this reader.
+    bool ReadNext(FrameRecord& out);
+
+    uint64_t Dropped() const;
+
+  private:
+    bool ReadIndex(uint64_t index, FrameRecord& out) const;
+
+    int fd_;
+    const Region* region_;
+    uint64_t cursor_;
+    uint64_t dropped_;
+  };
+} // namespace pshm
+
+#endif // POSE_SHM_H
@@ -49,9 +49,6 @@ namespace rlft
     off_x = ((float)win_w - draw_w) * 0.5f;
     off_y = ((float)win_h - draw_h) * 0.5f;
 
-    BeginDrawing();
-    ClearBackground(BLACK);
-
     Rectangle src;
     src.x = 0.0f;
     src.y = 0.0f;
@@ -71,14 +68,6 @@ namespace rlft
     DrawTexturePro(tex, src, dst, origin, 0.0f, WHITE);
   }
 
-  Vector2 MapToWindow(const cv::Point2f& p, float scale, float off_x, float off_y)
-  {
-    Vector2 v;
-    v.x = off_x + p.x * scale;
-    v.y = off_y + p.y * scale;
-    return v;
-  }
-
   Camera3D MakeOpenCVCamera(const cv::Mat& K, int img_w, int img_h)
   {
     double fy = K.at<double>(1, 1);
@@ -92,25 +81,12 @@ namespace rlft
     return cam;
   }
 
-  void DrawAxisBarsAtPose(const cv::Vec3d& rvec, const cv::Vec3d& tvec, float len, float thick)
+  void DrawModelAtPoseLit(Model& model, const cv::Vec3d& rvec, const cv::Vec3d& tvec)
   {
-    Vector3 axis;
-    float ang_deg = 0.0f;
-
-    rlPushMatrix();
-    rlTranslatef((float)tvec[0], (float)tvec[1], (float)tvec[2]);
-
-    if (RvecToAxisAngle(rvec, axis, ang_deg))
-      rlRotatef(ang_deg, axis.x, axis.y, axis.z);
-
-    DrawCubeV((Vector3){len * 0.5f, 0.0f, 0.0f}, (Vector3){len, thick, thick}, RED);
-    DrawCubeV((Vector3){0.0f, len * 0.5f, 0.0f}, (Vector3){thick, len, thick}, GREEN);
-    DrawCubeV((Vector3){0.0f, 0.0f, len * 0.5f}, (Vector3){thick, thick, len}, BLUE);
-
-    rlPopMatrix();
+    DrawModelAtPoseColored(model, rvec, tvec, (Color){15, 25, 70, 255});
   }
 
-  void DrawModelAtPoseLit(Model& model, const cv::Vec3d& rvec, const cv::Vec3d& tvec)
+  void DrawModelAtPoseColored(Model& model, const cv::Vec3d& rvec, const cv::Vec3d& tvec, Color diffuse)
   {
     Vector3 axis;
     float ang_deg = 0.0f;
@@ -121,7 +97,7 @@ namespace rlft
     if (RvecToAxisAngle(rvec, axis, ang_deg))
       rlRotatef(ang_deg, axis.x, axis.y, axis.z);
 
-    model.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = (Color){15, 25, 70, 255};
+    model.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = diffuse;
 
     DrawModel(model, (Vector3){0.0f, 0.0f, 0.0f}, 1.0f, WHITE);
 
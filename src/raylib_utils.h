@@ -9,10 +9,9 @@ namespace rlft
 {
   std::filesystem::path AssetPath(const std::filesystem::path& rel);
   void DrawWebcamTexture(Texture2D tex, int img_w, int img_h, float& scale, float& off_x, float& off_y, float& draw_w, float& draw_h);
-  Vector2 MapToWindow(const cv::Point2f& p, float scale, float off_x, float off_y);
   Camera3D MakeOpenCVCamera(const cv::Mat& K, int img_w, int img_h);
-  void DrawAxisBarsAtPose(const cv::Vec3d& rvec, const cv::Vec3d& tvec, float len, float thick);
   void DrawModelAtPoseLit(Model& model, const cv::Vec3d& rvec, const cv::Vec3d& tvec);
+  void DrawModelAtPoseColored(Model& model, const cv::Vec3d& rvec, const cv::Vec3d& tvec, Color diffuse);
 } // namespace rlft
 
 #endif // RAYLIB_UTILS_H
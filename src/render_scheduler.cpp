@@ -0,0 +1,79 @@
+#include "render_scheduler.h"
+#include <raylib.h>
+
+namespace
+{
+  // Wake up slightly before the next frame is due so a blocking read does not add a full period of latency.
+  constexpr double kWakeMargin = 0.002;
+  constexpr double kMinWait = 0.001;
+} // namespace
+
+namespace rlft
+{
+  RenderScheduler::RenderScheduler(double source_fps, double baseline_fps)
+    : period_((source_fps > 0.0) ? 1.0 / source_fps : 1.0 / 30.0)
+    , baseline_fps_(baseline_fps)
+    , start_time_(GetTime())
+    , last_frame_time_(0.0)
+    , new_frame_(false)
+    , dirty_(true)
+    , presented_(0)
+    , on_event_(0)
+    , idle_seconds_(0.0)
+  {
+  }
+
+  void RenderScheduler::NotifyFrame()
+  {
+    new_frame_ = true;
+    last_frame_time_ = GetTime();
+  }
+
+  void RenderScheduler::Invalidate()
+  {
+    dirty_ = true;
+  }
+
+  bool RenderScheduler::ShouldPresent() const
+  {
+    return new_frame_ || dirty_;
+  }
+
+  void RenderScheduler::Presented()
+  {
+    presented_++;
+    if (!new_frame_)
+      on_event_++;
+
+    new_frame_ = false;
+    dirty_ = false;
+  }
+
+  void RenderScheduler::Idle()
+  {
+    // Without EndDrawing nobody polls the window, keep input and close requests flowing.
+    PollInputEvents();
+
+    double wait = last_frame_time_ + period_ - GetTime() - kWakeMargin;
+    if (wait < kMinWait)
+      wait = kMinWait;
+    if (wait > period_)
+      wait = period_;
+
+    double t0 = GetTime();
+    WaitTime(wait);
+    idle_seconds_ += GetTime() - t0;
+  }
+
+  RenderScheduler::Stats RenderScheduler::GetStats() const
+  {
+    Stats st;
+    st.presented = presented_;
+    st.on_event = on_event_;
+    st.idle_seconds = idle_seconds_;
+
+    long long baseline = (long long)((GetTime() - start_time_) * baseline_fps_);
+    st.avoided = (baseline > presented_) ? baseline - presented_ : 0;
+    return st;
+  }
+} // namespace rlft
@@ -0,0 +1,49 @@
+#ifndef RENDER_SCHEDULER_H
+#define RENDER_SCHEDULER_H
+
+namespace rlft
+{
+  // Decides whether a loop iteration has anything new to present. Frames are drawn only when the camera delivered
+  // a frame (the CV result of a frame arrives with it) or the window/input state changed, the rest of the time is
+  // handed back to the CPU by sleeping towards the next expected camera frame.
+  class RenderScheduler
+  {
+  public:
+    struct Stats
+    {
+      long long presented;
+      // Presents caused only by input or window events, without new camera data.
+      long long on_event;
+      // Redraws a loop at the fixed baseline rate would have issued over the same time, minus the ones presented.
+      long long avoided;
+      double idle_seconds;
+    };
+
+    // baseline_fps is the rate of the fixed-rate loop this replaces, only used for the avoided count.
+    explicit RenderScheduler(double source_fps, double baseline_fps = 60.0);
+
+    void NotifyFrame();
+    void Invalidate();
+
+    bool ShouldPresent() const;
+    void Presented();
+    void Idle();
+
+    Stats GetStats() const;
+
+  private:
+    double period_;
+    double baseline_fps_;
+    double start_time_;
+    double last_frame_time_;
+
+    bool new_frame_;
+    bool dirty_;
+
+    long long presented_;
+    long long on_event_;
+    double idle_seconds_;
+  };
+} // namespace rlft
+
+#endif // RENDER_SCHEDULER_H
@@ -0,0 +1,567 @@
+#include "v4l2_capture.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+  // Retries ioctls interrupted by signals, as every V4L2 client has to.
+  int Xioctl(camh::V4L2Device& dev, unsigned long request, void* arg)
+  {
+    int r;
+    do
+    {
+      r = dev.Ioctl(request, arg);
+    } while (r == -1 && errno == EINTR);
+    return r;
+  }
+} // namespace
+
+namespace camh
+{
+  SystemV4L2Device::SystemV4L2Device(const std::string& path)
+    : path_(path)
+    , fd_(-1)
+  {
+  }
+
+  SystemV4L2Device::~SystemV4L2Device()
+  {
+    Close();
+  }
+
+  bool SystemV4L2Device::Open()
+  {
+    fd_ = open(path_.c_str(), O_RDWR | O_NONBLOCK);
+    return fd_ >= 0;
+  }
+
+  void SystemV4L2Device::Close()
+  {
+    if (fd_ >= 0)
+      close(fd_);
+    fd_ = -1;
+  }
+
+  int SystemV4L2Device::Ioctl(unsigned long request, void* arg)
+  {
+    return ioctl(fd_, request, arg);
+  }
+
+  void* SystemV4L2Device::Map(size_t length, off_t offset)
+  {
+    void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+    return (p == MAP_FAILED) ? nullptr : p;
+  }
+
+  void SystemV4L2Device::Unmap(void* addr, size_t length)
+  {
+    munmap(addr, length);
+  }
+
+  bool SystemV4L2Device::WaitReadable(int timeout_ms)
+  {
+    pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int r;
+    do
+    {
+      r = poll(&pfd, 1, timeout_ms);
+    } while (r == -1 && errno == EINTR);
+
+    return r > 0 && (pfd.revents & POLLIN);
+  }
+
+  FileV4L2Device::FileV4L2Device(const std::string& path, int width, int height, uint32_t fourcc, int fps)
+    : path_(path)
+    , width_(width)
+    , height_(height)
+    , fourcc_(fourcc)
+    , fps_((fps > 0) ? fps : 30)
+    , frame_count_(0)
+    , next_frame_(0)
+    , sequence_(0)
+    , streaming_(false)
+  {
+  }
+
+  size_t FileV4L2Device::FrameBytes() const
+  {
+    size_t pixels = (size_t)width_ * (size_t)height_;
+    if (fourcc_ == V4L2_PIX_FMT_YUYV)
+      return pixels * 2;
+    if (fourcc_ == V4L2_PIX_FMT_NV12)
+      return pixels * 3 / 2;
+    return pixels;
+  }
+
+  size_t FileV4L2Device::Stride() const
+  {
+    // Mimic driver offsets: one page-aligned window per buffer.
+    size_t page = 4096;
+    return (FrameBytes() + page - 1) / page * page;
+  }
+
+  bool FileV4L2Device::Open()
+  {
+    if (fourcc_ != V4L2_PIX_FMT_YUYV && fourcc_ != V4L2_PIX_FMT_GREY && fourcc_ != V4L2_PIX_FMT_NV12)
+      return false;
+
+    file_.open(path_, std::ios::binary);
+    if (!file_ || width_ <= 0 || height_ <= 0)
+      return false;
+
+    file_.seekg(0, std::ios::end);
+    size_t size = (size_t)file_.tellg();
+    frame_count_ = size / FrameBytes();
+    file_.seekg(0, std::ios::beg);
+
+    return frame_count_ > 0;
+  }
+
+  void FileV4L2Device::Close()
+  {
+    file_.close();
+    buffers_.clear();
+    queued_.clear();
+    queue_.clear();
+    streaming_ = false;
+  }
+
+  int FileV4L2Device::Ioctl(unsigned long request, void* arg)
+  {
+    switch (request)
+    {
+    case VIDIOC_QUERYCAP:
+    {
+      v4l2_capability* cap = static_cast<v4l2_capability*>(arg);
+      std::memset(cap, 0, sizeof(*cap));
+      std::strncpy(reinterpret_cast<char*>(cap->driver), "rlft-file", sizeof(cap->driver) - 1);
+      std::strncpy(reinterpret_cast<char*>(cap->card), path_.c_str(), sizeof(cap->card) - 1);
+      cap->device_caps = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING;
+      cap->capabilities = cap->device_caps | V4L2_CAP_DEVICE_CAPS;
+      return 0;
+    }
+    case VIDIOC_S_FMT:
+    case VIDIOC_G_FMT:
+    {
+      v4l2_format* fmt = static_cast<v4l2_format*>(arg);
+      if (fmt->type != V4L2_BUF_TYPE_VIDEO_CAPTURE)
+        break;
+      fmt->fmt.pix.width = (uint32_t)width_;
+      fmt->fmt.pix.height = (uint32_t)height_;
+      fmt->fmt.pix.pixelformat = fourcc_;
+      fmt->fmt.pix.field = V4L2_FIELD_NONE;
+      fmt->fmt.pix.bytesperline = (uint32_t)((fourcc_ == V4L2_PIX_FMT_YUYV) ? width_ * 2 : width_);
+      fmt->fmt.pix.sizeimage = (uint32_t)FrameBytes();
+      return 0;
+    }
+    case VIDIOC_S_PARM:
+    case VIDIOC_G_PARM:
+    {
+      v4l2_streamparm* parm = static_cast<v4l2_streamparm*>(arg);
+      if (parm->type != V4L2_BUF_TYPE_VIDEO_CAPTURE)
+        break;
+      parm->parm.capture.capability = V4L2_CAP_TIMEPERFRAME;
+      parm->parm.capture.timeperframe.numerator = 1;
+      parm->parm.capture.timeperframe.denominator = (uint32_t)fps_;
+      return 0;
+    }
+    case VIDIOC_REQBUFS:
+    {
+      v4l2_requestbuffers* req = static_cast<v4l2_requestbuffers*>(arg);
+      if (req->type != V4L2_BUF_TYPE_VIDEO_CAPTURE || req->memory != V4L2_MEMORY_MMAP || streaming_)
+        break;
+      buffers_.assign(req->count, std::vector<uint8_t>(Stride()));
+      queued_.assign(req->count, false);
+      queue_.clear();
+      return 0;
+    }
+    case VIDIOC_QUERYBUF:
+    case VIDIOC_QBUF:
+    {
+      v4l2_buffer* buf = static_cast<v4l2_buffer*>(arg);
+      if (buf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE || buf->memory != V4L2_MEMORY_MMAP || buf->index >= buffers_.size())
+        break;
+
+      if (request == VIDIOC_QUERYBUF)
+      {
+        buf->length = (uint32_t)FrameBytes();
+        buf->m.offset = (uint32_t)(buf->index * Stride());
+        buf->flags = queued_[buf->index] ? V4L2_BUF_FLAG_QUEUED : 0;
+        return 0;
+      }
+
+      if (queued_[buf->index])
+        break;
+      queued_[buf->index] = true;
+      queue_.push_back(buf->index);
+      return 0;
+    }
+    case VIDIOC_DQBUF:
+    {
+      v4l2_buffer* buf = static_cast<v4l2_buffer*>(arg);
+      if (buf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE || buf->memory != V4L2_MEMORY_MMAP || !streaming_)
+        break;
+      if (queue_.empty())
+      {
+        errno = EAGAIN;
+        return -1;
+      }
+
+      uint32_t index = queue_.front();
+      queue_.pop_front();
+      queued_[index] = false;
+
+      // The "DMA": fill the buffer with the next frame of the file.
+      if (next_frame_ >= frame_count_)
+        next_frame_ = 0;
+      file_.clear();
+      file_.seekg((std::streamoff)(next_frame_ * FrameBytes()), std::ios::beg);
+      file_.read(reinterpret_cast<char*>(buffers_[index].data()), (std::streamsize)FrameBytes());
+      next_frame_++;
+
+      auto now = std::chrono::steady_clock::now().time_since_epoch();
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+
+      buf->index = index;
+      buf->bytesused = (uint32_t)FrameBytes();
+      buf->field = V4L2_FIELD_NONE;
+      buf->sequence = sequence_++;
+      buf->flags = V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC;
+      buf->timestamp.tv_sec = (time_t)(us / 1000000);
+      buf->timestamp.tv_usec = (suseconds_t)(us % 1000000);
+      return 0;
+    }
+    case VIDIOC_STREAMON:
+      streaming_ = true;
+      next_due_ = std::chrono::steady_clock::now();
+      return 0;
+    case VIDIOC_STREAMOFF:
+      streaming_ = false;
+      for (size_t i = 0; i < queued_.size(); i++)
+        queued_[i] = false;
+      queue_.clear();
+      return 0;
+    default:
+      errno = ENOTTY;
+      return -1;
+    }
+
+    errno = EINVAL;
+    return -1;
+  }
+
+  void* FileV4L2Device::Map(size_t length, off_t offset)
+  {
+    size_t index = (size_t)offset / Stride();
+    if (index >= buffers_.size() || length > buffers_[index].size())
+      return nullptr;
+    return buffers_[index].data();
+  }
+
+  void FileV4L2Device::Unmap(void* addr, size_t length)
+  {
+    (void)addr;
+    (void)length;
+  }
+
+  bool FileV4L2Device::WaitReadable(int timeout_ms)
+  {
+    if (!streaming_ || queue_.empty())
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+      return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (next_due_ > now + std::chrono::milliseconds(timeout_ms))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+      return false;
+    }
+
+    std::this_thread::sleep_until(next_due_);
+    next_due_ = std::max(next_due_, now) + std::chrono::microseconds(1000000 / fps_);
+    return true;
+  }
+
+  V4L2Capture::V4L2Capture(std::unique_ptr<V4L2Device> device, int requested_width, int requested_height, int requested_fps, uint32_t fourcc, int buffer_count)
+    : device_(std::move(device))
+    , held_(-1)
+    , streaming_(false)
+    , width_(0)
+    , height_(0)
+    , bytes_per_line_(0)
+    , fps_(0.0)
+    , fourcc_(fourcc)
+    , last_sequence_(0)
+    , latency_samples_(0)
+    , stats_{0, 0, 0, 0, 0.0, 0.0, 0.0}
+  {
+    if (!device_ || !device_->Open())
+    {
+      std::cerr << "Could not open V4L2 device: " << std::strerror(errno) << "\n";
+      return;
+    }
+
+    if (!Start(requested_width, requested_height, requested_fps, buffer_count))
+    {
+      Stop();
+      device_->Close();
+    }
+  }
+
+  V4L2Capture::~V4L2Capture()
+  {
+    Stop();
+    if (device_)
+      device_->Close();
+  }
+
+  bool V4L2Capture::Start(int requested_width, int requested_height, int requested_fps, int buffer_count)
+  {
+    v4l2_capability cap;
+    std::memset(&cap, 0, sizeof(cap));
+    if (Xioctl(*device_, VIDIOC_QUERYCAP, &cap) != 0)
+    {
+      std::cerr << "VIDIOC_QUERYCAP failed: " << std::strerror(errno) << "\n";
+      return false;
+    }
+
+    uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING))
+    {
+      std::cerr << "V4L2 device does not support streaming capture\n";
+      return false;
+    }
+
+    v4l2_format fmt;
+    std::memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = (uint32_t)requested_width;
+    fmt.fmt.pix.height = (uint32_t)requested_height;
+    fmt.fmt.pix.pixelformat = fourcc_;
+    fmt.fmt.pix.field = V4L2_FIELD_ANY;
+    if (Xioctl(*device_, VIDIOC_S_FMT, &fmt) != 0)
+    {
+      std::cerr << "VIDIOC_S_FMT failed: " << std::strerror(errno) << "\n";
+      return false;
+    }
+
+    if (fmt.fmt.pix.pixelformat != fourcc_)
+    {
+      std::cerr << "V4L2 device does not offer the requested pixel format\n";
+      return false;
+    }
+
+    width_ = (int)fmt.fmt.pix.width;
+    height_ = (int)fmt.fmt.pix.height;
+    bytes_per_line_ = (int)fmt.fmt.pix.bytesperline;
+
+    v4l2_streamparm parm;
+    std::memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (requested_fps > 0)
+    {
+      parm.parm.capture.timeperframe.numerator = 1;
+      parm.parm.capture.timeperframe.denominator = (uint32_t)requested_fps;
+      Xioctl(*device_, VIDIOC_S_PARM, &parm);
+    }
+    if (Xioctl(*device_, VIDIOC_G_PARM, &parm) == 0 && parm.parm.capture.timeperframe.numerator > 0)
+      fps_ = (double)parm.parm.capture.timeperframe.denominator / (double)parm.parm.capture.timeperframe.numerator;
+
+    v4l2_requestbuffers req;
+    std::memset(&req, 0, sizeof(req));
+    req.count = (uint32_t)buffer_count;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (Xioctl(*device_, VIDIOC_REQBUFS, &req) != 0 || req.count < 2)
+    {
+      std::cerr << "VIDIOC_REQBUFS failed: " << std::strerror(errno) << "\n";
+      return false;
+    }
+
+    for (uint32_t i = 0; i < req.count; i++)
+    {
+      v4l2_buffer buf;
+      std::memset(&buf, 0, sizeof(buf));
+      buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      buf.memory = V4L2_MEMORY_MMAP;
+      buf.index = i;
+      if (Xioctl(*device_, VIDIOC_QUERYBUF, &buf) != 0)
+      {
+        std::cerr << "VIDIOC_QUERYBUF failed: " << std::strerror(errno) << "\n";
+        return false;
+      }
+
+      Buffer b;
+      b.length = buf.length;
+      b.start = device_->Map(buf.length, (off_t)buf.m.offset);
+      if (!b.start)
+      {
+        std::cerr << "Could not map V4L2 buffer " << i << "\n";
+        return false;
+      }
+      buffers_.push_back(b);
+
+      if (Xioctl(*device_, VIDIOC_QBUF, &buf) != 0)
+      {
+        std::cerr << "VIDIOC_QBUF failed: " << std::strerror(errno) << "\n";
+        return false;
+      }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (Xioctl(*device_, VIDIOC_STREAMON, &type) != 0)
+    {
+      std::cerr << "VIDIOC_STREAMON failed: " << std::strerror(errno) << "\n";
+      return false;
+    }
+
+    streaming_ = true;
+    stats_.buffer_count = (int)buffers_.size();
+
+    std::cerr << "V4L2 capture started. WxH=" << width_ << "x" << height_ << " FPS=" << fps_ << " buffers=" << buffers_.size() << "\n";
+    return true;
+  }
+
+  void V4L2Capture::Stop()
+  {
+    if (streaming_)
+    {
+      v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      Xioctl(*device_, VIDIOC_STREAMOFF, &type);
+      streaming_ = false;
+    }
+    held_ = -1;
+
+    for (const Buffer& b : buffers_)
+      device_->Unmap(b.start, b.length);
+
+    if (!buffers_.empty())
+    {
+      v4l2_requestbuffers req;
+      std::memset(&req, 0, sizeof(req));
+      req.count = 0;
+      req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      req.memory = V4L2_MEMORY_MMAP;
+      Xioctl(*device_, VIDIOC_REQBUFS, &req);
+    }
+    buffers_.clear();
+  }
+
+  bool V4L2Capture::IsOpened() const
+  {
+    return streaming_;
+  }
+
+  int V4L2Capture::Width() const
+  {
+    return width_;
+  }
+
+  int V4L2Capture::Height() const
+  {
+    return height_;
+  }
+
+  int V4L2Capture::BytesPerLine() const
+  {
+    return bytes_per_line_;
+  }
+
+  double V4L2Capture::Fps() const
+  {
+    return fps_;
+  }
+
+  uint32_t V4L2Capture::PixelFormat() const
+  {
+    return fourcc_;
+  }
+
+  bool V4L2Capture::Grab(V4L2Frame& out)
+  {
+    if (!streaming_)
+      return false;
+
+    if (held_ >= 0)
+    {
+      v4l2_buffer buf;
+      std::memset(&buf, 0, sizeof(buf));
+      buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      buf.memory = V4L2_MEMORY_MMAP;
+      buf.index = (uint32_t)held_;
+      Xioctl(*device_, VIDIOC_QBUF, &buf);
+      held_ = -1;
+    }
+
+    if (!device_->WaitReadable(1000))
+      return false;
+
+    v4l2_buffer buf;
+    std::memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (Xioctl(*device_, VIDIOC_DQBUF, &buf) != 0)
+      return false;
+
+    if (buf.index >= buffers_.size())
+      return false;
+
+    if (stats_.frames + stats_.errors > 0 && buf.sequence > last_sequence_ + 1)
+      stats_.dropped += buf.sequence - last_sequence_ - 1;
+    last_sequence_ = buf.sequence;
+
+    // Corrupted frames go straight back to the driver.
+    if (buf.flags & V4L2_BUF_FLAG_ERROR)
+    {
+      stats_.errors++;
+      Xioctl(*device_, VIDIOC_QBUF, &buf);
+      return false;
+    }
+
+    stats_.frames++;
+
+    out.timestamp_ns = 0;
+
+    // steady_clock is CLOCK_MONOTONIC, the clock of V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC.
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+    {
+      out.timestamp_ns = (uint64_t)buf.timestamp.tv_sec * 1000000000ull + (uint64_t)buf.timestamp.tv_usec * 1000ull;
+
+      auto captured = std::chrono::seconds(buf.timestamp.tv_sec) + std::chrono::microseconds(buf.timestamp.tv_usec);
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch() - captured).count();
+
+      latency_samples_++;
+      stats_.last_latency_ms = ms;
+      stats_.avg_latency_ms += (ms - stats_.avg_latency_ms) / (double)latency_samples_;
+      if (ms > stats_.max_latency_ms)
+        stats_.max_latency_ms = ms;
+    }
+
+    held_ = (int)buf.index;
+
+    out.data = static_cast<const uint8_t*>(buffers_[buf.index].start);
+    out.bytes_used = buf.bytesused;
+    out.sequence = buf.sequence;
+    return true;
+  }
+
+  const V4L2Stats& V4L2Capture::Stats() const
+  {
+    return stats_;
+  }
+} // namespace camh
@@ -0,0 +1,153 @@
+#ifndef V4L2_CAPTURE_H
+#define V4L2_CAPTURE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace camh
+{
+  // Syscall seam of the capture backend, so the same ioctl flow runs against a real device or a file.
+  class V4L2Device
+  {
+  public:
+    virtual ~V4L2Device() = default;
+
+    virtual bool Open() = 0;
+    virtual void Close() = 0;
+    virtual int Ioctl(unsigned long request, void* arg) = 0;
+    virtual void* Map(size_t length, off_t offset) = 0;
+    virtual void Unmap(void* addr, size_t length) = 0;
+    virtual bool WaitReadable(int timeout_ms) = 0;
+  };
+
+  class SystemV4L2Device : public V4L2Device
+  {
+  public:
+    explicit SystemV4L2Device(const std::string& path);
+    ~SystemV4L2Device() override;
+
+    bool Open() override;
+    void Close() override;
+    int Ioctl(unsigned long request, void* arg) override;
+    void* Map(size_t length, off_t offset) override;
+    void Unmap(void* addr, size_t length) override;
+    bool WaitReadable(int timeout_ms) override;
+
+  private:
+    std::string path_;
+    int fd_;
+  };
+
+  // Fake device replaying raw frames from a file. Format and size are fixed by the file, S_FMT reports them back
+  // like a driver that cannot honour the request. Frames are paced at the given rate and loop at end of file.
+  class FileV4L2Device : public V4L2Device
+  {
+  public:
+    FileV4L2Device(const std::string& path, int width, int height, uint32_t fourcc, int fps);
+
+    bool Open() override;
+    void Close() override;
+    int Ioctl(unsigned long request, void* arg) override;
+    void* Map(size_t length, off_t offset) override;
+    void Unmap(void* addr, size_t length) override;
+    bool WaitReadable(int timeout_ms) override;
+
+  private:
+    size_t FrameBytes() const;
+    size_t Stride() const;
+
+    std::string path_;
+    std::ifstream file_;
+    int width_;
+    int height_;
+    uint32_t fourcc_;
+    int fps_;
+    size_t frame_count_;
+    size_t next_frame_;
+    uint32_t sequence_;
+    bool streaming_;
+
+    std::vector<std::vector<uint8_t>> buffers_;
+    std::vector<bool> queued_;
+    std::deque<uint32_t> queue_;
+    std::chrono::steady_clock::time_point next_due_;
+  };
+
+  struct V4L2Frame
+  {
+    const uint8_t* data;
+    uint32_t bytes_used;
+    uint32_t sequence;
+    // Driver capture time on CLOCK_MONOTONIC (steady_clock), 0 when the driver uses another clock.
+    uint64_t timestamp_ns;
+  };
+
+  struct V4L2Stats
+  {
+    int buffer_count;
+    uint64_t frames;
+    uint64_t dropped;
+    // Buffers the driver flagged with V4L2_BUF_FLAG_ERROR, requeued without being handed out.
+    uint64_t errors;
+    // Driver capture timestamp to the buffer reaching userspace. Only sampled for monotonic timestamps.
+    double last_latency_ms;
+    double avg_latency_ms;
+    double max_latency_ms;
+  };
+
+  // Streaming mmap capture. A dequeued buffer stays owned by the caller until the next Grab, which queues it back.
+  class V4L2Capture
+  {
+  public:
+    V4L2Capture(std::unique_ptr<V4L2Device> device, int requested_width, int requested_height, int requested_fps, uint32_t fourcc, int buffer_count);
+    ~V4L2Capture();
+
+    V4L2Capture(const V4L2Capture&) = delete;
+    V4L2Capture& operator=(const V4L2Capture&) = delete;
+
+    bool IsOpened() const;
+    int Width() const;
+    int Height() const;
+    int BytesPerLine() const;
+    double Fps() const;
+    uint32_t PixelFormat() const;
+
+    bool Grab(V4L2Frame& out);
+
+    const V4L2Stats& Stats() const;
+
+  private:
+    struct Buffer
+    {
+      void* start;
+      size_t length;
+    };
+
+    bool Start(int requested_width, int requested_height, int requested_fps, int buffer_count);
+    void Stop();
+
+    std::unique_ptr<V4L2Device> device_;
+    std::vector<Buffer> buffers_;
+    int held_;
+    bool streaming_;
+
+    int width_;
+    int height_;
+    int bytes_per_line_;
+    double fps_;
+    uint32_t fourcc_;
+    uint32_t last_sequence_;
+    uint64_t latency_samples_;
+
+    V4L2Stats stats_;
+  };
+} // namespace camh
+
+#endif // V4L2_CAPTURE_H
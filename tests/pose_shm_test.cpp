@@ -0,0 +1,191 @@
+#include "pose_shm.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Forks a pshm::Reader against a writer publishing as fast as it can. The reader checks that frame ids only
+// increase, that every record it gets is internally consistent (no torn copies) and that Dropped() accounts
+// for exactly the ids it never saw.
+namespace
+{
+  constexpr uint64_t kFrames = 2000000;
+
+  void Fill(pshm::FrameRecord& f, uint64_t id)
+  {
+    f.frame_id = id;
+    f.capture_ns = id * 3;
+    f.publish_ns = id * 5;
+    f.image_width = (uint32_t)id;
+    f.image_height = (uint32_t)(id >> 32);
+    f.face_count = (uint32_t)(id % pshm::kMaxFaces) + 1;
+    for (uint32_t k = 0; k < f.face_count; k++)
+    {
+      pshm::FaceRecord& r = f.faces[k];
+      r.id = (uint32_t)(id * pshm::kMaxFaces + k);
+      for (int i = 0; i < 4; i++)
+        r.bbox[i] = (int32_t)(id + i);
+      for (int i = 0; i < pshm::kLandmarkCount; i++)
+      {
+        r.landmarks[i][0] = (float)(id % 4096);
+        r.landmarks[i][1] = (float)i;
+      }
+      for (int i = 0; i < 3; i++)
+      {
+        r.rvec[i] = (double)id;
+        r.tvec[i] = (double)(id + k);
+      }
+    }
+  }
+
+  bool Consistent(const pshm::FrameRecord& f)
+  {
+    uint64_t id = f.frame_id;
+    if (f.capture_ns != id * 3 || f.publish_ns != id * 5 || f.image_width != (uint32_t)id || f.image_height != (uint32_t)(id >> 32))
+      return false;
+    if (f.face_count != (uint32_t)(id % pshm::kMaxFaces) + 1)
+      return false;
+
+    for (uint32_t k = 0; k < f.face_count; k++)
+    {
+      const pshm::FaceRecord& r = f.faces[k];
+      if (r.id != (uint32_t)(id * pshm::kMaxFaces + k))
+        return false;
+      for (int i = 0; i < 4; i++)
+        if (r.bbox[i] != (int32_t)(id + i))
+          return false;
+      for (int i = 0; i < pshm::kLandmarkCount; i++)
+        if (r.landmarks[i][0] != (float)(id % 4096) || r.landmarks[i][1] != (float)i)
+          return false;
+      for (int i = 0; i < 3; i++)
+        if (r.rvec[i] != (double)id || r.tvec[i] != (double)(id + k))
+          return false;
+    }
+
+    return true;
+  }
+
+  int RunReader(const std::string& name, int ready_fd)
+  {
+    pshm::Reader reader(name);
+    if (!reader.IsOpen())
+      return 10;
+
+    // A reader only follows frames published after it attached, so the writer waits for this.
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1)
+      return 10;
+    close(ready_fd);
+
+    pshm::FrameRecord frame;
+    uint64_t last = 0;
+    uint64_t got = 0;
+    uint64_t gaps = 0;
+    uint64_t bad = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+
+    while (last < kFrames)
+    {
+      if (!reader.ReadNext(frame))
+      {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+          std::fprintf(stderr, "reader timed out at frame %llu\n", (unsigned long long)last);
+          return 11;
+        }
+        std::this_thread::yield();
+        continue;
+      }
+
+      if (frame.frame_id <= last)
+      {
+        std::fprintf(stderr, "frame id went from %llu to %llu\n", (unsigned long long)last, (unsigned long long)frame.frame_id);
+        return 12;
+      }
+
+      if (!Consistent(frame))
+        bad++;
+
+      gaps += frame.frame_id - last - 1;
+      last = frame.frame_id;
+      got++;
+    }
+
+    std::printf("reader: got=%llu dropped=%llu bad=%llu\n", (unsigned long long)got, (unsigned long long)reader.Dropped(), (unsigned long long)bad);
+    std::fflush(stdout);
+
+    if (bad != 0)
+      return 13;
+    if (reader.Dropped() != gaps || got + reader.Dropped() != kFrames)
+    {
+      std::fprintf(stderr, "dropped %llu, missing ids %llu\n", (unsigned long long)reader.Dropped(), (unsigned long long)gaps);
+      return 14;
+    }
+
+    return 0;
+  }
+} // namespace
+
+int main()
+{
+  std::string name = "rlft_pose_shm_test_" + std::to_string((long)getpid());
+
+  pshm::Writer writer(name);
+  if (!writer.IsOpen())
+    return 1;
+
+  // A second writer on the same name must fail and leave the first one's segment in place.
+  {
+    pshm::Writer second(name);
+    if (second.IsOpen())
+    {
+      std::fprintf(stderr, "second writer opened the ring\n");
+      return 1;
+    }
+  }
+
+  int ready_pipe[2];
+  if (pipe(ready_pipe) != 0)
+    return 1;
+
+  pid_t pid = fork();
+  if (pid < 0)
+    return 1;
+
+  if (pid == 0)
+  {
+    close(ready_pipe[0]);
+    int rc = RunReader(name, ready_pipe[1]);
+    std::fflush(stdout);
+    _exit(rc);
+  }
+
+  close(ready_pipe[1]);
+  char ready = 0;
+  if (read(ready_pipe[0], &ready, 1) != 1)
+  {
+    std::fprintf(stderr, "reader did not attach\n");
+    waitpid(pid, nullptr, 0);
+    return 1;
+  }
+  close(ready_pipe[0]);
+
+  for (uint64_t id = 1; id <= kFrames; id++)
+  {
+    Fill(writer.BeginWrite(), id);
+    writer.EndWrite();
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    std::fprintf(stderr, "reader failed with status %d\n", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    return 1;
+  }
+
+  return 0;
+}
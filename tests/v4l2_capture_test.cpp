@@ -0,0 +1,194 @@
+#include "v4l2_capture.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <linux/videodev2.h>
+#include <unistd.h>
+
+// Drives V4L2Capture through FileV4L2Device: file looping, sequence numbers, bytes used, buffer requeue,
+// drop and error accounting. A wrapping device injects the driver misbehaviour the fake never produces.
+namespace
+{
+  constexpr int kWidth = 64;
+  constexpr int kHeight = 48;
+  constexpr int kFileFrames = 3;
+  constexpr uint32_t kFrameBytes = kWidth * kHeight * 2;
+
+  int failures = 0;
+
+  void Check(bool ok, const char* what)
+  {
+    if (!ok)
+    {
+      std::fprintf(stderr, "FAIL: %s\n", what);
+      failures++;
+    }
+  }
+
+  // Skips two sequence numbers after frame skip_after and flags frame error_at as corrupted.
+  class FaultyDevice : public camh::V4L2Device
+  {
+  public:
+    FaultyDevice(std::unique_ptr<camh::V4L2Device> inner, uint32_t skip_after, uint32_t error_at)
+      : inner_(std::move(inner))
+      , skip_after_(skip_after)
+      , error_at_(error_at)
+    {
+    }
+
+    bool Open() override
+    {
+      return inner_->Open();
+    }
+
+    void Close() override
+    {
+      inner_->Close();
+    }
+
+    void* Map(size_t length, off_t offset) override
+    {
+      return inner_->Map(length, offset);
+    }
+
+    void Unmap(void* addr, size_t length) override
+    {
+      inner_->Unmap(addr, length);
+    }
+
+    bool WaitReadable(int timeout_ms) override
+    {
+      return inner_->WaitReadable(timeout_ms);
+    }
+
+    int Ioctl(unsigned long request, void* arg) override
+    {
+      int r = inner_->Ioctl(request, arg);
+      if (r == 0 && request == VIDIOC_DQBUF)
+      {
+        v4l2_buffer* buf = static_cast<v4l2_buffer*>(arg);
+        if (buf->sequence == error_at_)
+          buf->flags |= V4L2_BUF_FLAG_ERROR;
+        if (buf->sequence > skip_after_)
+          buf->sequence += 2;
+      }
+      return r;
+    }
+
+  private:
+    std::unique_ptr<camh::V4L2Device> inner_;
+    uint32_t skip_after_;
+    uint32_t error_at_;
+  };
+
+  std::string WriteFrames()
+  {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("v4l2_capture_test_" + std::to_string((long)getpid()) + ".yuyv");
+    std::ofstream os(path, std::ios::binary);
+    for (int f = 0; f < kFileFrames; f++)
+    {
+      std::vector<uint8_t> frame(kFrameBytes, (uint8_t)(10 + f));
+      os.write(reinterpret_cast<const char*>(frame.data()), (std::streamsize)frame.size());
+    }
+    return path.string();
+  }
+
+  void TestLoopingAndRequeue(const std::string& path)
+  {
+    const int buffers = 4;
+    camh::V4L2Capture cap(std::make_unique<camh::FileV4L2Device>(path, kWidth, kHeight, V4L2_PIX_FMT_YUYV, 200), kWidth, kHeight, 200, V4L2_PIX_FMT_YUYV, buffers);
+
+    Check(cap.IsOpened(), "capture opens");
+    if (!cap.IsOpened())
+      return;
+
+    Check(cap.Width() == kWidth && cap.Height() == kHeight, "negotiated size");
+    Check(cap.BytesPerLine() == kWidth * 2, "YUYV bytes per line");
+    Check(cap.PixelFormat() == V4L2_PIX_FMT_YUYV, "pixel format");
+    Check(cap.Fps() == 200.0, "frame rate");
+
+    std::set<const uint8_t*> seen;
+    const int grabs = 7;
+    for (int i = 0; i < grabs; i++)
+    {
+      camh::V4L2Frame frame;
+      bool ok = cap.Grab(frame);
+      Check(ok, "grab succeeds");
+      if (!ok)
+        return;
+
+      // With every buffer but the held one queued, buffers only keep coming if each Grab requeues the last one.
+      seen.insert(frame.data);
+      Check(frame.bytes_used == kFrameBytes, "bytes used");
+      Check(frame.sequence == (uint32_t)i, "sequence");
+      uint64_t now_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+      Check(frame.timestamp_ns > 0 && frame.timestamp_ns <= now_ns, "monotonic capture timestamp");
+      Check(frame.data[0] == 10 + i % kFileFrames && frame.data[kFrameBytes - 1] == 10 + i % kFileFrames, "file loops frame by frame");
+    }
+
+    Check((int)seen.size() <= buffers, "only the mapped buffers are handed out");
+
+    const camh::V4L2Stats& st = cap.Stats();
+    Check(st.buffer_count == buffers, "buffer count");
+    Check(st.frames == (uint64_t)grabs, "frame count");
+    Check(st.dropped == 0 && st.errors == 0, "no drops or errors");
+    Check(st.last_latency_ms >= 0.0 && st.max_latency_ms >= st.avg_latency_ms, "latency stats");
+  }
+
+  void TestDropsAndErrors(const std::string& path)
+  {
+    // Two buffers: a corrupted frame that is not requeued leaves a single buffer cycling.
+    auto file = std::make_unique<camh::FileV4L2Device>(path, kWidth, kHeight, V4L2_PIX_FMT_YUYV, 200);
+    camh::V4L2Capture cap(std::make_unique<FaultyDevice>(std::move(file), 1, 3), kWidth, kHeight, 200, V4L2_PIX_FMT_YUYV, 2);
+
+    Check(cap.IsOpened(), "faulty capture opens");
+    if (!cap.IsOpened())
+      return;
+
+    // Driver sequences 0 1 4 5(error) 6 ... arrive as device sequences 0 1 2 3 4.
+    int good = 0;
+    int failed = 0;
+    std::set<const uint8_t*> after_error;
+    for (int i = 0; i < 10; i++)
+    {
+      camh::V4L2Frame frame;
+      if (cap.Grab(frame))
+      {
+        good++;
+        Check(frame.sequence != 5, "corrupted frame is not handed out");
+        if (failed > 0)
+          after_error.insert(frame.data);
+      }
+      else
+      {
+        failed++;
+      }
+    }
+
+    const camh::V4L2Stats& st = cap.Stats();
+    Check(failed == 1 && good == 9, "only the corrupted frame fails");
+    Check(st.errors == 1, "error count");
+    Check(st.dropped == 2, "skipped sequences count as dropped");
+    Check(st.frames == 9, "good frame count");
+    Check(after_error.size() == 2, "corrupted buffer is requeued");
+  }
+} // namespace
+
+int main()
+{
+  std::string path = WriteFrames();
+
+  TestLoopingAndRequeue(path);
+  TestDropsAndErrors(path);
+
+  std::filesystem::remove(path);
+
+  if (failures == 0)
+    std::printf("v4l2_capture_test: all checks passed\n");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,342 @@
+#include "face_cv.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// Accuracy-vs-speed report of FaceCV on a synth_faces dataset. Exits non-zero when a threshold is missed,
+// so the same run works as a regression check. Pose errors are gated on the median so a single solvePnP flip
+// does not fail the run, and a broad regression is not hidden by a few good frames; a threshold of 0 disables it.
+// --write-baseline records the measured metrics, --baseline turns a recorded file into thresholds with the
+// margins below. Flags are applied in order, so explicit thresholds after --baseline override it.
+// Usage: face_eval <cascade.xml> <lbfmodel.yaml> <dataset_dir> [--compact-lbf] [--downscale n]
+//                  [--min-recall r] [--max-rot-deg d] [--max-trans-rel t] [--min-fps f]
+//                  [--baseline file] [--write-baseline file]
+namespace
+{
+  struct GroundTruth
+  {
+    int width;
+    int height;
+    cv::Vec3d rvec;
+    cv::Vec3d tvec;
+    cv::Point2f center;
+    float radius;
+    bool occluded;
+  };
+
+  struct Totals
+  {
+    int heads[2] = {0, 0};
+    int found[2] = {0, 0};
+    std::vector<double> rot_err_deg;
+    std::vector<double> trans_err_rel;
+    int frames = 0;
+    double process_ms = 0.0;
+  };
+
+  struct Baseline
+  {
+    double recall;
+    double rot_median_deg;
+    double trans_median_rel;
+    double fps;
+  };
+
+  // Allowed regression against a baseline: recall may drop by 0.05, median pose errors may grow by 25% plus a
+  // small absolute slack for near-zero baselines, and throughput may halve, since timings vary between runs.
+  constexpr double kRecallMargin = 0.05;
+  constexpr double kErrorGrowth = 1.25;
+  constexpr double kRotSlackDeg = 1.0;
+  constexpr double kTransSlack = 0.01;
+  constexpr double kFpsFactor = 0.5;
+
+  double NowMs()
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  bool LoadGroundTruth(const std::filesystem::path& csv, std::map<std::string, std::vector<GroundTruth>>& out)
+  {
+    std::ifstream in(csv);
+    if (!in)
+      return false;
+
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line))
+    {
+      std::replace(line.begin(), line.end(), ',', ' ');
+      std::istringstream ss(line);
+      std::string file;
+      GroundTruth g;
+      int occluded = 0;
+      if (ss >> file >> g.width >> g.height >> g.rvec[0] >> g.rvec[1] >> g.rvec[2] >> g.tvec[0] >> g.tvec[1] >> g.tvec[2] >> g.center.x >> g.center.y >> g.radius >> occluded)
+      {
+        g.occluded = (occluded != 0);
+        out[file].push_back(g);
+      }
+    }
+
+    return !out.empty();
+  }
+
+  double RotationErrorDeg(const cv::Vec3d& a, const cv::Vec3d& b)
+  {
+    cv::Mat ra;
+    cv::Mat rb;
+    cv::Rodrigues(a, ra);
+    cv::Rodrigues(b, rb);
+    cv::Mat d = ra.t() * rb;
+    double c = (cv::trace(d)[0] - 1.0) * 0.5;
+    c = std::max(-1.0, std::min(1.0, c));
+    return std::acos(c) * 180.0 / CV_PI;
+  }
+
+  double Percentile(std::vector<double> v, double p)
+  {
+    if (v.empty())
+      return 0.0;
+    // Nearest-rank: the smallest value with at least p of the samples at or below it.
+    size_t k = (size_t)std::max(1.0, std::ceil(p * (double)v.size())) - 1;
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+  }
+
+  double Median(const std::vector<double>& v)
+  {
+    return Percentile(v, 0.5);
+  }
+
+  double Mean(const std::vector<double>& v)
+  {
+    double s = 0.0;
+    for (double x : v)
+      s += x;
+    return v.empty() ? 0.0 : s / (double)v.size();
+  }
+
+  // One "key value" pair per line, as written by SaveBaseline.
+  bool LoadBaseline(const std::filesystem::path& path, Baseline& out)
+  {
+    std::ifstream in(path);
+    if (!in)
+      return false;
+
+    int seen = 0;
+    std::string key;
+    double value = 0.0;
+    while (in >> key >> value)
+    {
+      if (key == "recall")
+      {
+        out.recall = value;
+        seen |= 1;
+      }
+      else if (key == "rot_median_deg")
+      {
+        out.rot_median_deg = value;
+        seen |= 2;
+      }
+      else if (key == "trans_median_rel")
+      {
+        out.trans_median_rel = value;
+        seen |= 4;
+      }
+      else if (key == "fps")
+      {
+        out.fps = value;
+        seen |= 8;
+      }
+    }
+
+    return seen == 15;
+  }
+
+  bool SaveBaseline(const std::filesystem::path& path, const Baseline& b)
+  {
+    std::ofstream out(path);
+    if (!out)
+      return false;
+
+    out << "recall " << b.recall << "\n";
+    out << "rot_median_deg " << b.rot_median_deg << "\n";
+    out << "trans_median_rel " << b.trans_median_rel << "\n";
+    out << "fps " << b.fps << "\n";
+    return (bool)out;
+  }
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " <cascade.xml> <lbfmodel.yaml> <dataset_dir> [--compact-lbf] [--downscale n] [--min-recall r] [--max-rot-deg d] [--max-trans-rel t] [--min-fps f] [--baseline file] [--write-baseline file]\n";
+    return 2;
+  }
+
+  std::string cascade_path = argv[1];
+  std::string lbf_path = argv[2];
+  std::filesystem::path dataset = argv[3];
+  bool compact_lbf = false;
+  // Same detector resolution as rl_face_tracker.
+  int downscale = 2;
+  double min_recall = 0.5;
+  double max_rot_deg = 15.0;
+  double max_trans_rel = 0.2;
+  double min_fps = 5.0;
+  std::filesystem::path write_baseline;
+
+  for (int i = 4; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--compact-lbf")
+      compact_lbf = true;
+    else if (arg == "--downscale" && i + 1 < argc)
+      downscale = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--min-recall" && i + 1 < argc)
+      min_recall = std::atof(argv[++i]);
+    else if (arg == "--max-rot-deg" && i + 1 < argc)
+      max_rot_deg = std::atof(argv[++i]);
+    else if (arg == "--max-trans-rel" && i + 1 < argc)
+      max_trans_rel = std::atof(argv[++i]);
+    else if (arg == "--min-fps" && i + 1 < argc)
+      min_fps = std::atof(argv[++i]);
+    else if (arg == "--baseline" && i + 1 < argc)
+    {
+      Baseline b;
+      if (!LoadBaseline(argv[++i], b))
+      {
+        std::cerr << "Could not read baseline " << argv[i] << "\n";
+        return 2;
+      }
+      min_recall = b.recall - kRecallMargin;
+      max_rot_deg = b.rot_median_deg * kErrorGrowth + kRotSlackDeg;
+      max_trans_rel = b.trans_median_rel * kErrorGrowth + kTransSlack;
+      min_fps = b.fps * kFpsFactor;
+    }
+    else if (arg == "--write-baseline" && i + 1 < argc)
+      write_baseline = argv[++i];
+    else
+      std::cerr << "Ignoring argument " << arg << "\n";
+  }
+
+  std::map<std::string, std::vector<GroundTruth>> gt;
+  if (!LoadGroundTruth(dataset / "gt.csv", gt))
+  {
+    std::cerr << "Could not read " << (dataset / "gt.csv").string() << "\n";
+    return 2;
+  }
+
+  const GroundTruth& first = gt.begin()->second.front();
+  cvfd::FaceCV face(cascade_path, lbf_path, first.width, first.height, 5, 1, downscale, compact_lbf);
+
+  Totals t;
+  for (const auto& entry : gt)
+  {
+    cv::Mat img = cv::imread((dataset / entry.first).string(), cv::IMREAD_GRAYSCALE);
+    if (img.empty())
+    {
+      std::cerr << "Could not read " << entry.first << "\n";
+      continue;
+    }
+
+    double t0 = NowMs();
+    cvfd::FaceResult res = face.Process(img);
+    t.process_ms += NowMs() - t0;
+    t.frames++;
+
+    std::vector<bool> used(res.faces.size(), false);
+    for (const GroundTruth& g : entry.second)
+    {
+      int k = g.occluded ? 1 : 0;
+      t.heads[k]++;
+
+      // A detection matches the closest unused box containing the projected head origin.
+      int best = -1;
+      double best_d = 0.0;
+      for (size_t i = 0; i < res.faces.size(); i++)
+      {
+        const cv::Rect& b = res.faces[i].bbox;
+        if (used[i] || !b.contains(cv::Point((int)g.center.x, (int)g.center.y)))
+          continue;
+        cv::Point2f c(b.x + b.width * 0.5f, b.y + b.height * 0.5f);
+        double d = cv::norm(c - g.center);
+        if (best < 0 || d < best_d)
+        {
+          best = (int)i;
+          best_d = d;
+        }
+      }
+
+      if (best < 0)
+        continue;
+
+      used[best] = true;
+      t.found[k]++;
+
+      const cvfd::FacePose& p = res.faces[best];
+      t.rot_err_deg.push_back(RotationErrorDeg(g.rvec, p.rvec));
+      t.trans_err_rel.push_back(cv::norm(p.tvec - g.tvec) / cv::norm(g.tvec));
+    }
+  }
+
+  int heads = t.heads[0] + t.heads[1];
+  int found = t.found[0] + t.found[1];
+  double recall = heads > 0 ? (double)found / heads : 0.0;
+  double fps = t.process_ms > 0.0 ? t.frames * 1000.0 / t.process_ms : 0.0;
+  double rot_median = Median(t.rot_err_deg);
+  double trans_median = Median(t.trans_err_rel);
+
+  std::cout << "backend:        " << (compact_lbf ? "compact" : "opencv") << ", downscale " << downscale << "\n";
+  std::cout << "frames:         " << t.frames << ", " << (t.frames > 0 ? t.process_ms / t.frames : 0.0) << " ms/frame, " << fps << " fps\n";
+  std::cout << "recall:         " << recall << " (visible " << t.found[0] << "/" << t.heads[0] << ", occluded " << t.found[1] << "/" << t.heads[1] << ")\n";
+  std::cout << "rotation err:   median " << rot_median << " deg, p90 " << Percentile(t.rot_err_deg, 0.9) << " deg, mean " << Mean(t.rot_err_deg) << " deg\n";
+  std::cout << "translation err: median " << trans_median << ", p90 " << Percentile(t.trans_err_rel, 0.9) << ", mean " << Mean(t.trans_err_rel) << " (relative to distance)\n";
+
+  if (!write_baseline.empty())
+  {
+    Baseline b = {recall, rot_median, trans_median, fps};
+    if (!SaveBaseline(write_baseline, b))
+    {
+      std::cerr << "Could not write baseline " << write_baseline.string() << "\n";
+      return 2;
+    }
+    std::cout << "baseline written to " << write_baseline.string() << "\n";
+    return 0;
+  }
+
+  std::cout << "thresholds:     recall >= " << min_recall << ", median rotation <= " << max_rot_deg << " deg, median translation <= " << max_trans_rel << ", fps >= " << min_fps << " (0 = off)\n";
+
+  bool pass = true;
+  if (min_recall > 0.0 && recall < min_recall)
+  {
+    std::cerr << "FAIL recall " << recall << " < " << min_recall << "\n";
+    pass = false;
+  }
+  if (max_rot_deg > 0.0 && rot_median > max_rot_deg)
+  {
+    std::cerr << "FAIL median rotation " << rot_median << " > " << max_rot_deg << " deg\n";
+    pass = false;
+  }
+  if (max_trans_rel > 0.0 && trans_median > max_trans_rel)
+  {
+    std::cerr << "FAIL median translation " << trans_median << " > " << max_trans_rel << "\n";
+    pass = false;
+  }
+  if (min_fps > 0.0 && fps < min_fps)
+  {
+    std::cerr << "FAIL fps " << fps << " < " << min_fps << "\n";
+    pass = false;
+  }
+
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include "lbf_compact.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <opencv2/face.hpp>
+
+// Accuracy-delta report of the compact LBF regressor against cv::face::FacemarkLBF on the same faces.
+// Usage: lbf_compare <cascade.xml> <lbfmodel.yaml> <image|video>... [--save model.lbfc]
+namespace
+{
+  struct Totals
+  {
+    long long faces = 0;
+    double sum_err_px = 0.0;
+    double max_err_px = 0.0;
+    double sum_nme = 0.0;
+    double opencv_ms = 0.0;
+    double compact_ms = 0.0;
+  };
+
+  double NowMs()
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void ProcessFrame(const cv::Mat& bgr, cv::CascadeClassifier& cascade, cv::Ptr<cv::face::Facemark>& facemark, const cvfd::LbfCompact& compact, Totals& t)
+  {
+    cv::Mat gray;
+    if (bgr.channels() == 3)
+      cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+    else
+      gray = bgr;
+    cv::equalizeHist(gray, gray);
+
+    std::vector<cv::Rect> faces;
+    cascade.detectMultiScale(gray, faces, 1.1, 2, 0, cv::Size(30, 30));
+
+    for (const cv::Rect& face : faces)
+    {
+      std::vector<cv::Rect> one(1, face);
+      std::vector<std::vector<cv::Point2f>> ref;
+
+      double t0 = NowMs();
+      bool ok = facemark->fit(gray, one, ref);
+      double t1 = NowMs();
+
+      std::vector<cv::Point2f> got;
+      bool ok_compact = compact.Fit(gray, face, got);
+      double t2 = NowMs();
+
+      if (!ok || ref.empty() || !ok_compact || ref[0].size() != got.size() || got.size() < 46)
+        continue;
+
+      double iod = cv::norm(ref[0][36] - ref[0][45]);
+      double sum = 0.0;
+      for (size_t i = 0; i < got.size(); i++)
+      {
+        double e = cv::norm(got[i] - ref[0][i]);
+        sum += e;
+        t.max_err_px = std::max(t.max_err_px, e);
+      }
+
+      t.faces++;
+      t.sum_err_px += sum / (double)got.size();
+      t.sum_nme += (iod > 0.0) ? sum / (double)got.size() / iod : 0.0;
+      t.opencv_ms += t1 - t0;
+      t.compact_ms += t2 - t1;
+    }
+  }
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " <cascade.xml> <lbfmodel.yaml> <image|video>... [--save model.lbfc]\n";
+    return 2;
+  }
+
+  std::string cascade_path = argv[1];
+  std::string model_path = argv[2];
+  std::string save_path;
+  std::vector<std::string> inputs;
+
+  for (int i = 3; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--save" && i + 1 < argc)
+      save_path = argv[++i];
+    else
+      inputs.push_back(arg);
+  }
+
+  cv::CascadeClassifier cascade;
+  if (!cascade.load(cascade_path))
+  {
+    std::cerr << "Could not load cascade " << cascade_path << "\n";
+    return 1;
+  }
+
+  cv::Ptr<cv::face::Facemark> facemark = cv::face::FacemarkLBF::create();
+  facemark->loadModel(model_path);
+
+  std::shared_ptr<const cvfd::LbfCompact> compact = cvfd::LbfCompact::Load(model_path);
+  if (!compact)
+    return 1;
+
+  if (!save_path.empty() && !compact->Save(save_path))
+    std::cerr << "Could not write " << save_path << "\n";
+
+  Totals t;
+  for (const std::string& in : inputs)
+  {
+    cv::Mat img = cv::imread(in);
+    if (!img.empty())
+    {
+      ProcessFrame(img, cascade, facemark, *compact, t);
+      continue;
+    }
+
+    cv::VideoCapture cap(in);
+    cv::Mat frame;
+    while (cap.read(frame))
+      ProcessFrame(frame, cascade, facemark, *compact, t);
+  }
+
+  std::cout << "compact model bytes: " << compact->MemoryBytes() << "\n";
+  std::cout << "faces compared: " << t.faces << "\n";
+  if (t.faces == 0)
+    return 1;
+
+  std::cout << "mean landmark delta px: " << t.sum_err_px / t.faces << "\n";
+  std::cout << "max landmark delta px: " << t.max_err_px << "\n";
+  std::cout << "mean delta / inter-ocular: " << t.sum_nme / t.faces << "\n";
+  std::cout << "opencv fit ms/face: " << t.opencv_ms / t.faces << "\n";
+  std::cout << "compact fit ms/face: " << t.compact_ms / t.faces << "\n";
+  return 0;
+}
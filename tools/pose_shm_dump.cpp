@@ -0,0 +1,41 @@
+#include "pose_shm.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+// Minimal consumer of the face pose ring: prints every frame it sees together with its publish latency.
+int main(int argc, char** argv)
+{
+  std::string name = (argc > 1) ? argv[1] : "rl_face_tracker";
+  long long max_frames = (argc > 2) ? std::atoll(argv[2]) : -1;
+
+  pshm::Reader reader(name);
+  if (!reader.IsOpen())
+    return 1;
+
+  pshm::FrameRecord frame;
+  long long seen = 0;
+
+  while (max_frames < 0 || seen < max_frames)
+  {
+    if (!reader.ReadNext(frame))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      continue;
+    }
+
+    seen++;
+    double latency_ms = (double)(pshm::NowNs() - frame.capture_ns) / 1e6;
+
+    std::cout << "frame=" << frame.frame_id << " faces=" << frame.face_count << " latency_ms=" << latency_ms << " dropped=" << reader.Dropped() << "\n";
+
+    for (uint32_t i = 0; i < frame.face_count; i++)
+    {
+      const pshm::FaceRecord& f = frame.faces[i];
+      std::cout << "  id=" << f.id << " bbox=" << f.bbox[0] << "," << f.bbox[1] << "," << f.bbox[2] << "x" << f.bbox[3] << " tvec=" << f.tvec[0] << "," << f.tvec[1] << "," << f.tvec[2] << "\n";
+    }
+  }
+
+  return 0;
+}
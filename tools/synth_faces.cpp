@@ -0,0 +1,260 @@
+#include "raylib_utils.h"
+#include <raylib.h>
+#include "rlights.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+// Renders head.obj offscreen with known poses into an image sequence plus gt.csv for face_eval.
+// Every head lies fully inside the frame and no two heads overlap, so occluded=0 really means unoccluded.
+// Runs on any GL 3.3 context, including Mesa llvmpipe under xvfb-run.
+// Usage: synth_faces <out_dir> [frames=200] [seed=1] [width=1280] [height=720]
+namespace
+{
+  struct HeadSample
+  {
+    cv::Vec3d rvec;
+    cv::Vec3d tvec;
+    float u;
+    float v;
+    float radius;
+    bool occluded;
+    cv::Rect bounds;
+  };
+
+  constexpr int kPlacementAttempts = 30;
+
+  cv::Mat RotX(double a)
+  {
+    return (cv::Mat_<double>(3, 3) << 1, 0, 0, 0, std::cos(a), -std::sin(a), 0, std::sin(a), std::cos(a));
+  }
+
+  cv::Mat RotY(double a)
+  {
+    return (cv::Mat_<double>(3, 3) << std::cos(a), 0, std::sin(a), 0, 1, 0, -std::sin(a), 0, std::cos(a));
+  }
+
+  cv::Mat RotZ(double a)
+  {
+    return (cv::Mat_<double>(3, 3) << std::cos(a), -std::sin(a), 0, std::sin(a), std::cos(a), 0, 0, 0, 1);
+  }
+
+  unsigned char RandByte(std::mt19937& rng, int lo, int hi)
+  {
+    return (unsigned char)std::uniform_int_distribution<int>(lo, hi)(rng);
+  }
+
+  std::vector<cv::Point3f> MeshPoints(const Model& model)
+  {
+    std::vector<cv::Point3f> points;
+    for (int m = 0; m < model.meshCount; m++)
+    {
+      const Mesh& mesh = model.meshes[m];
+      for (int k = 0; k < mesh.vertexCount; k++)
+        points.push_back(cv::Point3f(mesh.vertices[3 * k], mesh.vertices[3 * k + 1], mesh.vertices[3 * k + 2]));
+    }
+    return points;
+  }
+
+  cv::Rect ProjectedBounds(const std::vector<cv::Point3f>& points, const cv::Vec3d& rvec, const cv::Vec3d& tvec, const cv::Mat& K)
+  {
+    std::vector<cv::Point2f> px;
+    cv::projectPoints(points, rvec, tvec, K, cv::noArray(), px);
+    return cv::boundingRect(px);
+  }
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <out_dir> [frames] [seed] [width] [height]\n";
+    return 2;
+  }
+
+  std::filesystem::path out_dir = argv[1];
+  int frames = (argc > 2) ? std::atoi(argv[2]) : 200;
+  unsigned seed = (argc > 3) ? (unsigned)std::atoi(argv[3]) : 1u;
+  int img_w = (argc > 4) ? std::atoi(argv[4]) : 1280;
+  int img_h = (argc > 5) ? std::atoi(argv[5]) : 720;
+
+  std::filesystem::create_directories(out_dir);
+  std::ofstream gt(out_dir / "gt.csv");
+  if (!gt)
+  {
+    std::cerr << "Could not write " << (out_dir / "gt.csv").string() << "\n";
+    return 1;
+  }
+  gt << "file,width,height,rx,ry,rz,tx,ty,tz,u,v,radius,occluded\n";
+
+  SetTraceLogLevel(LOG_WARNING);
+  SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  InitWindow(img_w, img_h, "synth_faces");
+
+  RenderTexture2D target = LoadRenderTexture(img_w, img_h);
+
+  Model head = LoadModel(rlft::AssetPath("head.obj").string().c_str());
+  Shader light_shader = LoadShader(rlft::AssetPath(std::filesystem::path("shaders") / "lighting.vs").string().c_str(), rlft::AssetPath(std::filesystem::path("shaders") / "lighting.fs").string().c_str());
+  for (int i = 0; i < head.materialCount; i++)
+    head.materials[i].shader = light_shader;
+
+  int loc_view_pos = GetShaderLocation(light_shader, "viewPos");
+  int loc_ambient = GetShaderLocation(light_shader, "ambient");
+  Light light = CreateLight(LIGHT_DIRECTIONAL, (Vector3){0.0f, 0.0f, 0.0f}, (Vector3){0.3f, -0.7f, 1.0f}, WHITE, light_shader);
+
+  // Same intrinsics as FaceCV so the recovered poses are directly comparable.
+  double f = (double)img_w;
+  double cx = img_w * 0.5;
+  double cy = img_h * 0.5;
+  cv::Mat K = (cv::Mat_<double>(3, 3) << f, 0, cx, 0, f, cy, 0, 0, 1);
+  Camera3D cam = rlft::MakeOpenCVCamera(K, img_w, img_h);
+
+  std::vector<cv::Point3f> head_points = MeshPoints(head);
+  cv::Point2f head_min(head_points.front().x, head_points.front().y);
+  cv::Point2f head_max = head_min;
+  for (const cv::Point3f& p : head_points)
+  {
+    head_min = cv::Point2f(std::min(head_min.x, p.x), std::min(head_min.y, p.y));
+    head_max = cv::Point2f(std::max(head_max.x, p.x), std::max(head_max.y, p.y));
+  }
+  const cv::Rect frame_rect(0, 0, img_w, img_h);
+
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  const double deg = CV_PI / 180.0;
+
+  for (int fi = 0; fi < frames; fi++)
+  {
+    int heads = 1 + (int)(unit(rng) * 3.0);
+    std::vector<HeadSample> samples;
+
+    // Nearest depth at which an upright head still fits its slot and the frame height, with 10% to spare for
+    // rotation. Poses whose projected mesh leaves the frame or overlaps another head are drawn again.
+    double slot_w = (double)img_w / heads;
+    double z_near = std::max(45.0, 1.1 * f * std::max((head_max.x - head_min.x) / slot_w, (head_max.y - head_min.y) / img_h));
+    double z_far = 2.0 * z_near;
+
+    for (int h = 0; h < heads; h++)
+    {
+      for (int attempt = 0; attempt < kPlacementAttempts; attempt++)
+      {
+        HeadSample s;
+        double z = z_near + unit(rng) * (z_far - z_near);
+        double u = slot_w * (h + 0.3 + 0.4 * unit(rng));
+        double v = img_h * (0.35 + 0.3 * unit(rng));
+
+        // head.obj has y up and the face towards +z, the camera looks down +z with y down: flip about x first.
+        cv::Mat R = RotZ((unit(rng) - 0.5) * 30.0 * deg) * RotY((unit(rng) - 0.5) * 60.0 * deg) * RotX((unit(rng) - 0.5) * 30.0 * deg) * RotX(CV_PI);
+        cv::Mat rvec;
+        cv::Rodrigues(R, rvec);
+
+        s.rvec = cv::Vec3d(rvec.at<double>(0), rvec.at<double>(1), rvec.at<double>(2));
+        s.tvec = cv::Vec3d((u - cx) * z / f, (v - cy) * z / f, z);
+        s.u = (float)u;
+        s.v = (float)v;
+        s.radius = (float)(16.0 * f / z);
+        s.occluded = unit(rng) < 0.25;
+        s.bounds = ProjectedBounds(head_points, s.rvec, s.tvec, K);
+
+        bool fits = (s.bounds & frame_rect) == s.bounds;
+        for (size_t k = 0; fits && k < samples.size(); k++)
+          fits = (s.bounds & samples[k].bounds).empty();
+
+        if (fits)
+        {
+          samples.push_back(s);
+          break;
+        }
+      }
+    }
+
+    Vector3 light_dir = {(float)(unit(rng) - 0.5), (float)(unit(rng) - 0.5), 1.0f};
+    light.target = light_dir;
+    unsigned char li = RandByte(rng, 150, 255);
+    light.color = (Color){li, li, li, 255};
+    float ambient[4] = {(float)(0.1 + 0.3 * unit(rng)), (float)(0.1 + 0.3 * unit(rng)), (float)(0.1 + 0.3 * unit(rng)), 1.0f};
+
+    BeginTextureMode(target);
+
+    unsigned char bg = RandByte(rng, 20, 200);
+    ClearBackground((Color){bg, bg, bg, 255});
+    for (int k = 0; k < 8; k++)
+    {
+      unsigned char c = RandByte(rng, 0, 255);
+      DrawRectangle((int)(unit(rng) * img_w), (int)(unit(rng) * img_h), (int)(unit(rng) * img_w * 0.3), (int)(unit(rng) * img_h * 0.3), (Color){c, c, c, 255});
+    }
+
+    BeginMode3D(cam);
+
+    Vector3 vp = cam.position;
+    SetShaderValue(light_shader, loc_view_pos, &vp.x, SHADER_UNIFORM_VEC3);
+    SetShaderValue(light_shader, loc_ambient, ambient, SHADER_UNIFORM_VEC4);
+    UpdateLightValues(light_shader, light);
+
+    for (const HeadSample& s : samples)
+    {
+      Color skin = (Color){RandByte(rng, 140, 235), RandByte(rng, 100, 180), RandByte(rng, 80, 150), 255};
+      rlft::DrawModelAtPoseColored(head, s.rvec, s.tvec, skin);
+    }
+
+    EndMode3D();
+
+    // Occluders cover a third of the face from a random side, clipped to their own head.
+    for (const HeadSample& s : samples)
+    {
+      if (!s.occluded)
+        continue;
+
+      float r = s.radius;
+      unsigned char c = RandByte(rng, 0, 255);
+      Color col = (Color){c, c, c, 255};
+      cv::Rect occ;
+      switch ((int)(unit(rng) * 4.0))
+      {
+      case 0:
+        occ = cv::Rect((int)(s.u - r), (int)(s.v + r * 0.33f), (int)(2.0f * r), (int)(r));
+        break;
+      case 1:
+        occ = cv::Rect((int)(s.u - r), (int)(s.v - r * 1.33f), (int)(2.0f * r), (int)(r));
+        break;
+      case 2:
+        occ = cv::Rect((int)(s.u - r * 1.33f), (int)(s.v - r), (int)(r), (int)(2.0f * r));
+        break;
+      default:
+        occ = cv::Rect((int)(s.u + r * 0.33f), (int)(s.v - r), (int)(r), (int)(2.0f * r));
+        break;
+      }
+
+      occ &= s.bounds;
+      DrawRectangle(occ.x, occ.y, occ.width, occ.height, col);
+    }
+
+    EndTextureMode();
+
+    Image img = LoadImageFromTexture(target.texture);
+    ImageFlipVertical(&img);
+
+    std::string name = TextFormat("frame_%05d.png", fi);
+    ExportImage(img, (out_dir / name).string().c_str());
+    UnloadImage(img);
+
+    for (const HeadSample& s : samples)
+    {
+      gt << name << "," << img_w << "," << img_h << "," << s.rvec[0] << "," << s.rvec[1] << "," << s.rvec[2] << "," << s.tvec[0] << "," << s.tvec[1] << "," << s.tvec[2] << "," << s.u << "," << s.v << "," << s.radius << "," << (s.occluded ? 1 : 0) << "\n";
+    }
+  }
+
+  UnloadShader(light_shader);
+  UnloadModel(head);
+  UnloadRenderTexture(target);
+  CloseWindow();
+  return 0;
+}